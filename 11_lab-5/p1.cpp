@@ -5,9 +5,25 @@
 #include <map>
 #include <set>
 #include <climits>
+#include <cstdint>
+#include <numeric>
 
 using namespace std;
 
+// Index of the lowest set bit of a non-zero mask
+static inline int lowestBit(uint64_t mask) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(mask);
+#else
+    int i = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
 struct Edge {
     int u, v, weight;
     char u_char, v_char; // For display purposes
@@ -52,8 +68,14 @@ public:
         UnionFind(int n) {
             parent.resize(n);
             rank.resize(n, 0);
-            for (int i = 0; i < n; i++) {
+            reset();
+        }
+        
+        // Back to n singletons, without reallocating
+        void reset() {
+            for (int i = 0; i < (int)parent.size(); i++) {
                 parent[i] = i;
+                rank[i] = 0;
             }
         }
         
@@ -85,90 +107,117 @@ public:
         }
     };
     
-    // Check if a subset of edges forms a spanning tree
-    bool isSpanningTree(const vector<bool>& subset) {
-        UnionFind uf(vertices);
-        int edgeCount = 0;
-        
-        // Add edges and check for cycles
-        for (int i = 0; i < edges.size(); i++) {
-            if (subset[i]) {
-                int u = vertex_map[edges[i].u_char];
-                int v = vertex_map[edges[i].v_char];
-                
-                if (uf.connected(u, v)) {
-                    return false; // Cycle detected
-                }
-                uf.unite(u, v);
-                edgeCount++;
-            }
-        }
-        
-        // Check if all vertices are connected (spanning tree has V-1 edges)
-        return edgeCount == vertices - 1;
-    }
-    
-    // Calculate total weight of a subset of edges
-    int calculateWeight(const vector<bool>& subset) {
-        int total = 0;
-        for (int i = 0; i < edges.size(); i++) {
-            if (subset[i]) {
-                total += edges[i].weight;
+    // Check if the edges in `mask` form a spanning tree. The caller only passes
+    // masks with V-1 edges, so no cycle means spanning
+    bool isSpanningTree(uint64_t mask, const vector<int>& from, const vector<int>& to, UnionFind& uf) {
+        uf.reset();
+        for (uint64_t rest = mask; rest != 0; rest &= rest - 1) {
+            int i = lowestBit(rest);
+            if (uf.connected(from[i], to[i])) {
+                return false; // Cycle detected
             }
+            uf.unite(from[i], to[i]);
         }
-        return total;
+        return true;
     }
     
-    // Generate all possible subsets using bitmasking
+    // Generate-and-test over edge subsets. Only subsets of exactly V-1 edges can
+    // be spanning trees, so walk just those masks in increasing order with
+    // Gosper's hack (next larger mask with the same number of bits) and keep
+    // the subset weight up to date from the bits that changed
     void findMST() {
         int n = edges.size();
-        int minWeight = INT_MAX;
-        vector<bool> bestSubset;
+        int k = vertices - 1;
+        long long minWeight = INT_MAX;
+        uint64_t bestMask = 0;
+        
+        if (n >= 64) {
+            cout << "Too many edges for generate-and-test (" << n << ", at most 63)." << endl;
+            return;
+        }
+        
+        // C(n, k) masks to test, built up as C(n - k + i, i). Dividing by the
+        // gcd first keeps every step exact without the product overflowing;
+        // saturate at LLONG_MAX in case it would not fit anyway
+        long long candidates = (k < 0 || k > n) ? 0 : 1;
+        for (int i = 1; i <= k && candidates > 0; i++) {
+            long long g = gcd(candidates, (long long)i);
+            long long factor = (n - k + i) / (i / g);
+            if (candidates / g > LLONG_MAX / factor) {
+                candidates = LLONG_MAX;
+                break;
+            }
+            candidates = candidates / g * factor;
+        }
         
         cout << "Generating all possible subsets of edges..." << endl;
         cout << "Total possible subsets: " << (1LL << n) << endl;
+        cout << "Subsets with V-1 = " << k << " edges to test: " << candidates << endl;
+        
+        // Endpoint indices looked up once instead of per mask
+        vector<int> from(n), to(n);
+        for (int i = 0; i < n; i++) {
+            from[i] = vertex_map[edges[i].u_char];
+            to[i] = vertex_map[edges[i].v_char];
+        }
         
-        // Generate all subsets using bitmask
-        long long totalSubsets = 1LL << n;
+        UnionFind uf(max(vertices, (int)vertex_chars.size()));
         int validTrees = 0;
+        long long processed = 0;
         
-        for (long long mask = 0; mask < totalSubsets; mask++) {
-            vector<bool> subset(n, false);
-            int edgeCount = 0;
-            
-            // Create subset from bitmask
-            for (int i = 0; i < n; i++) {
-                if (mask & (1LL << i)) {
-                    subset[i] = true;
-                    edgeCount++;
-                }
+        if (candidates > 0) {
+            uint64_t limit = 1ULL << n;
+            uint64_t mask = (k == 0) ? 0 : (1ULL << k) - 1;
+            long long weight = 0;
+            for (int i = 0; i < k; i++) {
+                weight += edges[i].weight;
             }
             
-            // Only consider subsets with exactly V-1 edges (necessary condition for spanning tree)
-            if (edgeCount == vertices - 1) {
-                if (isSpanningTree(subset)) {
+            while (true) {
+                if (isSpanningTree(mask, from, to, uf)) {
                     validTrees++;
-                    int weight = calculateWeight(subset);
                     if (weight < minWeight) {
                         minWeight = weight;
-                        bestSubset = subset;
+                        bestMask = mask;
                     }
                 }
-            }
-            
-            // Progress indicator for large graphs
-            if (mask % 1000000 == 0 && mask > 0) {
-                cout << "Processed " << mask << " subsets... Found " << validTrees << " valid spanning trees so far." << endl;
+                
+                // Progress indicator for large graphs
+                processed++;
+                if (processed % 1000000 == 0) {
+                    cout << "Processed " << processed << " subsets... Found " << validTrees << " valid spanning trees so far." << endl;
+                }
+                
+                if (mask == 0) break; // k == 0: the empty subset is the only one
+                
+                // Gosper's hack
+                uint64_t low = mask & (~mask + 1);
+                uint64_t ripple = mask + low;
+                uint64_t next = (((ripple ^ mask) >> 2) / low) | ripple;
+                if (next >= limit) break;
+                
+                uint64_t changed = mask ^ next;
+                for (uint64_t bits = changed & next; bits != 0; bits &= bits - 1) {
+                    weight += edges[lowestBit(bits)].weight;
+                }
+                for (uint64_t bits = changed & mask; bits != 0; bits &= bits - 1) {
+                    weight -= edges[lowestBit(bits)].weight;
+                }
+                mask = next;
             }
         }
         
         cout << "\n=== RESULTS ===" << endl;
         cout << "Total valid spanning trees found: " << validTrees << endl;
+        if (validTrees == 0) {
+            cout << "The graph has no spanning tree." << endl;
+            return;
+        }
         cout << "Minimum Spanning Tree Weight: " << minWeight << endl;
         cout << "Edges in MST:" << endl;
         
         for (int i = 0; i < n; i++) {
-            if (bestSubset[i]) {
+            if (bestMask & (1ULL << i)) {
                 cout << edges[i].u_char << " - " << edges[i].v_char << " : " << edges[i].weight << endl;
             }
         }
@@ -207,7 +256,7 @@ int main() {
     graph.displayGraph();
     
     cout << "\n=== FINDING MST USING GENERATE-AND-TEST METHOD ===" << endl;
-    cout << "Warning: This method has exponential time complexity O(2^E)" << endl;
+    cout << "Warning: This method has exponential time complexity O(C(E, V-1))" << endl;
     cout << "For large graphs, this will be very slow!" << endl;
     
     graph.findMST();
@@ -0,0 +1,67 @@
+#include <iostream>
+#include <string>
+#include <climits>
+
+#include "matrix_file.h"
+
+using namespace std;
+
+#define INF INT_MAX
+
+// Converts the text matrices used by p1/p2/p3 (V on the first line, then V rows
+// of V weights, INF = 2147483647) into the binary format from matrix_file.h.
+int main() {
+    cout << "=======================================" << endl;
+    cout << "  Text -> Binary Matrix Converter" << endl;
+    cout << "=======================================" << endl;
+
+    string input, output;
+    cout << "\nEnter the text matrix filename (e.g., graph.txt): ";
+    cin >> input;
+    cout << "Enter the output filename (e.g., graph.mat): ";
+    cin >> output;
+
+    int choice;
+    cout << "\nChoose element type:" << endl;
+    cout << "1. 64-bit (p1 maps it in place, no copy)" << endl;
+    cout << "2. 32-bit (half the size; p1 copies it, p2/p3 read it directly)" << endl;
+    cout << "Enter choice (1 or 2): ";
+    if (!(cin >> choice) || (choice != 1 && choice != 2)) {
+        cout << "Invalid choice!" << endl;
+        return 1;
+    }
+    MatrixDType dtype = (choice == 1) ? MATRIX_INT64 : MATRIX_INT32;
+    int64_t noEdge = (dtype == MATRIX_INT64) ? MATRIX_WIDE_NO_EDGE : INF;
+
+    TextMatrixReader reader;
+    if (!reader.open(input)) {
+        cout << "**Error:** " << reader.message("vertices") << endl;
+        return 1;
+    }
+    int V = reader.vertices();
+
+    string error;
+    bool ok = writeMatrixFile(output, V, dtype, noEdge, [&](int i, int64_t* row) {
+        if (!reader.readRow(i, row)) {
+            error = reader.message("vertices");
+            return false;
+        }
+        for (int j = 0; j < V; j++) {
+            int64_t weight = row[j];
+            if (dtype == MATRIX_INT32 && (weight < INT_MIN || weight > INT_MAX)) {
+                error = "Weight at row " + to_string(i) + ", column " + to_string(j) +
+                        " does not fit in 32 bits; choose the 64-bit type.";
+                return false;
+            }
+            row[j] = (weight == INF) ? noEdge : weight;
+        }
+        return true;
+    }, error);
+
+    if (!ok) {
+        cout << "**Error:** " << error << endl;
+        return 1;
+    }
+    cout << "\nWrote " << V << "x" << V << " matrix to " << output << endl;
+    return 0;
+}
@@ -0,0 +1,447 @@
+// Adjacency-matrix files shared by p1, p2, p3 and matrix_convert: the binary
+// format below and a fast reader for the text format. p4 only uses MappedFile
+// to read its adjacency-list and cost files.
+//
+// Binary layout: a 64-byte MatrixFileHeader followed by V rows of `rowStride` elements
+// (int32 or int64, native little-endian). rowStride pads every row to a multiple
+// of 64 bytes and dataOffset is 64-byte aligned, so a mapped file can be used
+// in place as a row-major matrix with cache-line aligned rows.
+#ifndef MATRIX_FILE_H
+#define MATRIX_FILE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <charconv>
+#include <thread>
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+enum MatrixDType : uint32_t {
+    MATRIX_INT32 = 1,
+    MATRIX_INT64 = 2
+};
+
+// "No edge" marker the converter writes into int64 files. It equals the
+// UNREACHABLE encoding of p1, which can then adopt the mapping without a copy.
+const int64_t MATRIX_WIDE_NO_EDGE = INT64_MAX / 4;
+
+const char MATRIX_FILE_MAGIC[8] = {'A', 'D', 'J', 'M', 'A', 'T', 'R', 'X'};
+const uint32_t MATRIX_FILE_VERSION = 1;
+const size_t MATRIX_FILE_ALIGNMENT = 64;
+
+struct MatrixFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t dtype;       // MatrixDType
+    uint64_t vertices;
+    uint64_t rowStride;   // elements per row, including padding
+    int64_t noEdge;       // value stored for "no edge" (INF in the text files)
+    uint64_t dataOffset;  // bytes from the start of the file to row 0
+    uint8_t reserved[16];
+};
+
+static_assert(sizeof(MatrixFileHeader) == 64, "MatrixFileHeader must stay 64 bytes");
+
+inline size_t matrixElementSize(uint32_t dtype) {
+    return dtype == MATRIX_INT64 ? 8 : 4;
+}
+
+// Read-only or copy-on-write mapping of a whole file. On platforms without
+// mmap the file is read into a heap buffer instead.
+class MappedFile {
+private:
+    void* addr;
+    size_t length;
+
+public:
+    MappedFile() : addr(nullptr), length(0) {}
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // `writable` gives a private copy-on-write mapping: writes never reach the file.
+    bool open(const std::string& path, bool writable) {
+        close();
+#ifdef _WIN32
+        std::ifstream in(path, std::ios::binary | std::ios::ate);
+        if (!in) return false;
+        length = (size_t)in.tellg();
+        addr = malloc(length);
+        if (addr == nullptr) return false;
+        in.seekg(0);
+        in.read(static_cast<char*>(addr), length);
+        (void)writable;
+        return (bool)in;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        length = (size_t)st.st_size;
+        int prot = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+        void* p = mmap(nullptr, length, prot, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) {
+            length = 0;
+            return false;
+        }
+        addr = p;
+        return true;
+#endif
+    }
+
+    void close() {
+        if (addr != nullptr) {
+            release(addr, length);
+            addr = nullptr;
+            length = 0;
+        }
+    }
+
+    // Give up ownership; the caller must later call release(base, size).
+    void* detach() {
+        void* p = addr;
+        addr = nullptr;
+        length = 0;
+        return p;
+    }
+
+    static void release(void* base, size_t size) {
+#ifdef _WIN32
+        (void)size;
+        free(base);
+#else
+        munmap(base, size);
+#endif
+    }
+
+    const char* data() const { return static_cast<const char*>(addr); }
+    char* mutableData() { return static_cast<char*>(addr); }
+    size_t size() const { return length; }
+};
+
+inline bool isMatrixFile(const std::string& path) {
+    char magic[8];
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f == nullptr) return false;
+    bool ok = fread(magic, 1, sizeof(magic), f) == sizeof(magic) &&
+              memcmp(magic, MATRIX_FILE_MAGIC, sizeof(magic)) == 0;
+    fclose(f);
+    return ok;
+}
+
+// True if `rows` rows of `stride` elements of `elementSize` bytes starting at
+// `offset` end by `limit`. Divides instead of multiplying, so header values from
+// a crafted file cannot wrap the product around and pass.
+inline bool regionFits(uint64_t offset, uint64_t rows, uint64_t stride, uint64_t elementSize,
+                       uint64_t limit) {
+    if (offset > limit) return false;
+    if (rows == 0 || stride == 0) return true;
+    return stride <= (limit - offset) / elementSize / rows;
+}
+
+// Map a matrix file and validate its header. On failure `error` says why.
+inline bool openMatrixFile(const std::string& path, bool writable, MappedFile& map,
+                           MatrixFileHeader& header, std::string& error) {
+    if (!map.open(path, writable)) {
+        error = "Could not open file: " + path;
+        return false;
+    }
+    if (map.size() < sizeof(MatrixFileHeader)) {
+        error = "File is too small to hold a matrix header.";
+        return false;
+    }
+    memcpy(&header, map.data(), sizeof(header));
+    if (memcmp(header.magic, MATRIX_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        error = "Not a binary matrix file (bad magic).";
+        return false;
+    }
+    if (header.version != MATRIX_FILE_VERSION) {
+        error = "Unsupported matrix file version " + std::to_string(header.version) + ".";
+        return false;
+    }
+    if (header.dtype != MATRIX_INT32 && header.dtype != MATRIX_INT64) {
+        error = "Unknown element type in matrix file.";
+        return false;
+    }
+    if (header.vertices == 0 || header.vertices > INT32_MAX || header.rowStride < header.vertices ||
+        header.dataOffset < sizeof(MatrixFileHeader) || header.dataOffset % MATRIX_FILE_ALIGNMENT != 0) {
+        error = "Corrupt matrix header.";
+        return false;
+    }
+    if (!regionFits(header.dataOffset, header.vertices, header.rowStride,
+                    matrixElementSize(header.dtype), map.size())) {
+        error = "File ended unexpectedly. Expected " + std::to_string(header.vertices) +
+                " rows for the matrix.";
+        return false;
+    }
+    return true;
+}
+
+// Write a V x V matrix; fillRow(i, out) must store row i as int64 values with
+// `noEdge` for missing edges, or return false (after setting `error`) to abort,
+// in which case the partial file is removed. Int32 files narrow each value on
+// the way out.
+inline bool writeMatrixFile(const std::string& path, int V, MatrixDType dtype, int64_t noEdge,
+                            const std::function<bool(int, int64_t*)>& fillRow, std::string& error) {
+    size_t elem = matrixElementSize(dtype);
+    size_t perLine = MATRIX_FILE_ALIGNMENT / elem;
+
+    MatrixFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MATRIX_FILE_MAGIC, sizeof(header.magic));
+    header.version = MATRIX_FILE_VERSION;
+    header.dtype = dtype;
+    header.vertices = V;
+    header.rowStride = (V + perLine - 1) / perLine * perLine;
+    header.noEdge = noEdge;
+    header.dataOffset = sizeof(MatrixFileHeader);
+
+    FILE* out = fopen(path.c_str(), "wb");
+    if (out == nullptr) {
+        error = "Could not create file: " + path;
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+
+    std::vector<int64_t> wide(header.rowStride, noEdge);
+    std::vector<int32_t> narrow(dtype == MATRIX_INT32 ? header.rowStride : 0);
+    bool aborted = false;
+    for (int i = 0; i < V && ok; i++) {
+        if (!fillRow(i, wide.data())) {
+            ok = false;
+            aborted = true;
+            break;
+        }
+        if (dtype == MATRIX_INT64) {
+            ok = fwrite(wide.data(), elem, header.rowStride, out) == header.rowStride;
+        } else {
+            for (size_t j = 0; j < header.rowStride; j++) narrow[j] = (int32_t)wide[j];
+            ok = fwrite(narrow.data(), elem, header.rowStride, out) == header.rowStride;
+        }
+    }
+    if (fclose(out) != 0) ok = false;
+    if (!ok) {
+        if (!aborted) error = "Failed while writing " + path;
+        remove(path.c_str());
+    }
+    return ok;
+}
+
+// Copy a matrix file into nested rows of T, translating the file's no-edge
+// value to `inf`. Used by the programs that keep vector<vector<int>> matrices.
+template <typename T>
+bool loadMatrixFileRows(const std::string& path, std::vector<std::vector<T>>& rows, T inf,
+                        std::string& error) {
+    MappedFile map;
+    MatrixFileHeader header;
+    if (!openMatrixFile(path, false, map, header, error)) {
+        return false;
+    }
+    int V = (int)header.vertices;
+    size_t rowBytes = header.rowStride * matrixElementSize(header.dtype);
+    rows.assign(V, std::vector<T>(V));
+    for (int i = 0; i < V; i++) {
+        const char* row = map.data() + header.dataOffset + i * rowBytes;
+        for (int j = 0; j < V; j++) {
+            int64_t value = (header.dtype == MATRIX_INT64)
+                                ? reinterpret_cast<const int64_t*>(row)[j]
+                                : reinterpret_cast<const int32_t*>(row)[j];
+            rows[i][j] = (value == header.noEdge) ? inf : (T)value;
+        }
+    }
+    return true;
+}
+
+// Reader for the text matrix format: V on the first line, then one row of V
+// whitespace-separated weights per line. The file is mapped once, line starts
+// are found with memchr and each row is parsed with std::from_chars, so there is
+// no stringstream and no per-token allocation; big files are parsed as parallel
+// row ranges. UTF-8 non-breaking spaces (some of the sample files contain them)
+// separate numbers like ordinary whitespace.
+class TextMatrixReader {
+public:
+    enum Status { OK, OPEN_FAILED, BAD_COUNT, TOO_FEW_ROWS, MISSING_WEIGHT };
+
+private:
+    MappedFile map;
+    int V;
+    std::vector<const char*> lineStarts; // one per row present, plus the end of the last
+
+    static bool skipSpace(const char*& p, const char* end, bool newlines) {
+        while (p < end) {
+            unsigned char c = *p;
+            if (c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f' || (newlines && c == '\n')) {
+                p++;
+            } else if (c == 0xC2 && p + 1 < end && (unsigned char)p[1] == 0xA0) {
+                p += 2;
+            } else {
+                break;
+            }
+        }
+        return p < end;
+    }
+
+public:
+    Status status;
+    std::string path;
+    int errorRow, errorColumn;
+
+    TextMatrixReader() : V(0), status(OK), errorRow(-1), errorColumn(-1) {}
+
+    // Map the file, read V and locate up to V rows. A short file is only
+    // reported once the rows it does have parsed, like the line-by-line loaders.
+    bool open(const std::string& filename) {
+        path = filename;
+        FILE* probe = fopen(filename.c_str(), "rb");
+        if (probe == nullptr) {
+            status = OPEN_FAILED;
+            return false;
+        }
+        fclose(probe);
+        if (!map.open(filename, false)) {
+            status = BAD_COUNT; // an empty file has no vertex count
+            return false;
+        }
+
+        const char* p = map.data();
+        const char* end = p + map.size();
+        skipSpace(p, end, true);
+        auto parsed = std::from_chars(p, end, V);
+        if (parsed.ec != std::errc() || V <= 0) {
+            status = BAD_COUNT;
+            return false;
+        }
+
+        // The rest of the count's line is ignored, as getline() used to do.
+        const char* line = static_cast<const char*>(memchr(parsed.ptr, '\n', end - parsed.ptr));
+        line = (line == nullptr) ? end : line + 1;
+        lineStarts.clear();
+        lineStarts.reserve(V + 1);
+        while ((int)lineStarts.size() < V && line < end) {
+            lineStarts.push_back(line);
+            const char* nl = static_cast<const char*>(memchr(line, '\n', end - line));
+            line = (nl == nullptr) ? end : nl + 1;
+        }
+        lineStarts.push_back(line);
+        return true;
+    }
+
+    int vertices() const { return V; }
+
+    int rows() const { return (int)lineStarts.size() - 1; }
+
+    // Parse row i into out[0..V). Returns the first column without a valid
+    // number, or -1 when the whole row parsed.
+    template <typename T>
+    int parseRow(int i, T* out) const {
+        const char* p = lineStarts[i];
+        const char* end = lineStarts[i + 1];
+        for (int j = 0; j < V; j++) {
+            if (!skipSpace(p, end, false)) return j;
+            if (*p == '+') p++; // operator>> accepted a leading plus
+            auto parsed = std::from_chars(p, end, out[j]);
+            if (parsed.ec != std::errc()) return j;
+            p = parsed.ptr;
+        }
+        return -1;
+    }
+
+    // Parse row i, recording the error for message() on failure.
+    template <typename T>
+    bool readRow(int i, T* out) {
+        if (i >= rows()) {
+            status = TOO_FEW_ROWS;
+            return false;
+        }
+        int column = parseRow(i, out);
+        if (column >= 0) {
+            status = MISSING_WEIGHT;
+            errorRow = i;
+            errorColumn = column;
+            return false;
+        }
+        return true;
+    }
+
+    // Parse every row; row(i) says where row i goes. On failure the error names
+    // the first bad row, exactly as a sequential read would.
+    template <typename T>
+    bool readRows(const std::function<T*(int)>& row) {
+        int present = rows();
+        size_t bytes = lineStarts.back() - lineStarts.front();
+        int threads = 1;
+        if (bytes > ((size_t)8 << 20)) {
+            threads = std::max(1, std::min((int)std::thread::hardware_concurrency(), present));
+        }
+
+        std::vector<int> badRow(threads, -1), badColumn(threads, -1);
+        auto work = [&](int t) {
+            int lo = (int)((long long)present * t / threads);
+            int hi = (int)((long long)present * (t + 1) / threads);
+            for (int i = lo; i < hi; i++) {
+                int column = parseRow(i, row(i));
+                if (column >= 0) {
+                    badRow[t] = i;
+                    badColumn[t] = column;
+                    return;
+                }
+            }
+        };
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; t++) pool.emplace_back(work, t);
+        work(0);
+        for (std::thread& th : pool) th.join();
+
+        for (int t = 0; t < threads; t++) {
+            if (badRow[t] >= 0) {
+                status = MISSING_WEIGHT;
+                errorRow = badRow[t];
+                errorColumn = badColumn[t];
+                return false;
+            }
+        }
+        if (present < V) {
+            status = TOO_FEW_ROWS;
+            return false;
+        }
+        return true;
+    }
+
+    // The messages the getline/stringstream loaders printed; `countName` is
+    // "vertices" or "cities" depending on the program.
+    std::string message(const std::string& countName) const {
+        switch (status) {
+            case OPEN_FAILED:
+                return "Could not open file: " + path;
+            case BAD_COUNT:
+                return "Invalid or missing number of " + countName + " in the first line.";
+            case TOO_FEW_ROWS:
+                return "File ended unexpectedly. Expected " + std::to_string(V) + " rows for the matrix.";
+            case MISSING_WEIGHT:
+                return "Missing weight at row " + std::to_string(errorRow) + ", column " +
+                       std::to_string(errorColumn) + ".";
+            default:
+                return "";
+        }
+    }
+};
+
+#endif
@@ -4,21 +4,691 @@
 #include <vector>
 #include <climits>
 #include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <charconv>
+#include <memory>
+#include <new>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cmath>
+#include <map>
+
+#include "matrix_file.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define FW_X86_SIMD 1
+#endif
 
 using namespace std;
 
 #define INF INT_MAX
 
+// Internal encoding of "no path" inside dist. INF (INT_MAX) from the input is mapped
+// to this sentinel so that dik + dkj never overflows and the relaxation needs no
+// per-element INF branch: any sum involving UNREACHABLE stays above UNREACHABLE / 2
+// and therefore never beats a real distance. Values that drift into that range
+// through negative edges are folded back to UNREACHABLE after each run.
+const long long UNREACHABLE = LLONG_MAX / 4;
+
+inline bool isUnreachable(long long d) {
+    return d >= UNREACHABLE / 2;
+}
+
+// Non-owning view of one matrix row, handed out by Matrix::operator[].
+template <typename T>
+class RowView {
+private:
+    T* ptr;
+    int len;
+
+public:
+    RowView(T* p, int n) : ptr(p), len(n) {}
+
+    T& operator[](int j) const { return ptr[j]; }
+    T* data() const { return ptr; }
+    int size() const { return len; }
+    T* begin() const { return ptr; }
+    T* end() const { return ptr + len; }
+};
+
+// Square matrix stored as one row-major buffer. Each row is padded to a multiple
+// of ALIGNMENT bytes so every row starts on a cache-line (and SIMD) boundary.
+template <typename T>
+class Matrix {
+public:
+    static constexpr size_t ALIGNMENT = 64;
+
+private:
+    int n;
+    size_t rowStride; // elements per row including padding
+    unique_ptr<T, function<void(T*)>> buffer;
+
+    static void freeBuffer(T* p) { free(p); }
+
+public:
+    Matrix() : n(0), rowStride(0), buffer(nullptr, freeBuffer) {}
+
+    Matrix(int size, T fill) : n(size), buffer(nullptr, freeBuffer) {
+        size_t perLine = ALIGNMENT / sizeof(T);
+        rowStride = (size + perLine - 1) / perLine * perLine;
+        size_t bytes = max<size_t>(rowStride * n * sizeof(T), ALIGNMENT);
+        T* raw = static_cast<T*>(aligned_alloc(ALIGNMENT, bytes));
+        if (raw == nullptr) {
+            throw bad_alloc();
+        }
+        buffer.reset(raw);
+        std::fill(raw, raw + rowStride * n, fill);
+    }
+
+    // Wrap memory owned elsewhere (e.g. a mapped file); `release` frees it.
+    static Matrix adopt(T* data, int size, size_t stride, function<void(T*)> release) {
+        Matrix m;
+        m.n = size;
+        m.rowStride = stride;
+        m.buffer = unique_ptr<T, function<void(T*)>>(data, release);
+        return m;
+    }
+
+    // Build from nested rows; used for the small predefined graphs.
+    static Matrix fromRows(const vector<vector<T>>& rows, T fill) {
+        Matrix m(rows.size(), fill);
+        for (int i = 0; i < m.n; i++) {
+            copy(rows[i].begin(), rows[i].end(), m.rowData(i));
+        }
+        return m;
+    }
+
+    RowView<T> operator[](int i) const { return RowView<T>(rowData(i), n); }
+    T* rowData(int i) const { return buffer.get() + (size_t)i * rowStride; }
+    int size() const { return n; }
+    size_t stride() const { return rowStride; }
+};
+
+typedef Matrix<long long> DistMatrix;
+typedef Matrix<int> NextMatrix;
+
+// Min-plus row relaxation: for j in [j0,j1), if dik + dk[j] < di[j] then take it and
+// set ni[j] = nik. All variants compute exactly the same result.
+typedef void (*RelaxRowFn)(long long* di, const long long* dk, int* ni,
+                           long long dik, int nik, int j0, int j1);
+
+static void relaxRowScalar(long long* di, const long long* dk, int* ni,
+                           long long dik, int nik, int j0, int j1) {
+    for (int j = j0; j < j1; j++) {
+        long long cand = dik + dk[j];
+        bool better = cand < di[j];
+        di[j] = better ? cand : di[j];
+        ni[j] = better ? nik : ni[j];
+    }
+}
+
+#ifdef FW_X86_SIMD
+// 4 lanes: 64-bit compare + blend for dist, the compare mask narrowed to 32-bit
+// lanes drives the blend for next.
+__attribute__((target("avx2")))
+static void relaxRowAVX2(long long* di, const long long* dk, int* ni,
+                         long long dik, int nik, int j0, int j1) {
+    const __m256i vdik = _mm256_set1_epi64x(dik);
+    const __m128i vnik = _mm_set1_epi32(nik);
+    const __m256i lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+    int j = j0;
+    for (; j + 4 <= j1; j += 4) {
+        __m256i cur = _mm256_loadu_si256((const __m256i*)(di + j));
+        __m256i cand = _mm256_add_epi64(vdik, _mm256_loadu_si256((const __m256i*)(dk + j)));
+        __m256i better = _mm256_cmpgt_epi64(cur, cand);
+        _mm256_storeu_si256((__m256i*)(di + j), _mm256_blendv_epi8(cur, cand, better));
+
+        __m128i mask32 = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(better, lowHalves));
+        __m128i curNext = _mm_loadu_si128((const __m128i*)(ni + j));
+        _mm_storeu_si128((__m128i*)(ni + j), _mm_blendv_epi8(curNext, vnik, mask32));
+    }
+    relaxRowScalar(di, dk, ni, dik, nik, j, j1);
+}
+
+// 8 lanes: the compare produces a k-mask that drives masked stores of both rows.
+__attribute__((target("avx512f,avx512vl")))
+static void relaxRowAVX512(long long* di, const long long* dk, int* ni,
+                           long long dik, int nik, int j0, int j1) {
+    const __m512i vdik = _mm512_set1_epi64(dik);
+    const __m256i vnik = _mm256_set1_epi32(nik);
+    int j = j0;
+    for (; j + 8 <= j1; j += 8) {
+        __m512i cur = _mm512_loadu_si512(di + j);
+        __m512i cand = _mm512_add_epi64(vdik, _mm512_loadu_si512(dk + j));
+        __mmask8 better = _mm512_cmplt_epi64_mask(cand, cur);
+        _mm512_mask_storeu_epi64(di + j, better, cand);
+        _mm256_mask_storeu_epi32(ni + j, better, vnik);
+    }
+    relaxRowScalar(di, dk, ni, dik, nik, j, j1);
+}
+#endif
+
+// Pick the widest kernel the running CPU supports.
+static RelaxRowFn selectRelaxRow(const char** name) {
+#ifdef FW_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")) {
+        *name = "AVX-512";
+        return relaxRowAVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "AVX2";
+        return relaxRowAVX2;
+    }
+#endif
+    *name = "scalar";
+    return relaxRowScalar;
+}
+
+// Reusable barrier for a fixed group of worker threads.
+class Barrier {
+private:
+    mutex lock;
+    condition_variable released;
+    int parties;
+    int waiting;
+    long long generation;
+
+public:
+    explicit Barrier(int count) : parties(count), waiting(0), generation(0) {}
+
+    void wait() {
+        unique_lock<mutex> guard(lock);
+        long long arrivedIn = generation;
+        if (++waiting == parties) {
+            waiting = 0;
+            generation++;
+            released.notify_all();
+        } else {
+            released.wait(guard, [&] { return generation != arrivedIn; });
+        }
+    }
+};
+
+// Run body(0..workers-1) with worker 0 on the calling thread, then join.
+static void runWorkers(int workers, const function<void(int)>& body) {
+    vector<thread> pool;
+    for (int w = 1; w < workers; w++) {
+        pool.emplace_back(body, w);
+    }
+    body(0);
+    for (thread& t : pool) {
+        t.join();
+    }
+}
+
+// Johnson's all-pairs shortest paths for sparse graphs. A Bellman-Ford pass from a
+// virtual source gives potentials h that make every reweighted edge
+// w(u,v) + h[u] - h[v] non-negative, after which one Dijkstra run per source
+// (binary heap, sources shared out to the workers) fills the same dist / next
+// matrices Floyd-Warshall produces. Cost is O(V E log V) instead of O(V^3).
+class Johnson {
+private:
+    int V;
+    vector<int> offsets; // CSR: edges of u are targets/costs[offsets[u] .. offsets[u+1])
+    vector<int> targets;
+    vector<long long> costs;
+    vector<long long> loops; // diagonal weights, UNREACHABLE if none
+    vector<long long> h;
+
+    // Returns false if the graph has a negative cycle.
+    bool computePotentials() {
+        h.assign(V, 0); // every vertex starts at distance 0 from the virtual source
+        for (int pass = 0; pass < V; pass++) {
+            bool changed = false;
+            for (int u = 0; u < V; u++) {
+                for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                    if (h[u] + costs[e] < h[targets[e]]) {
+                        h[targets[e]] = h[u] + costs[e];
+                        changed = true;
+                    }
+                }
+            }
+            if (!changed) return true;
+        }
+        return false;
+    }
+
+    void dijkstraRow(int s, DistMatrix& dist, NextMatrix& next, vector<long long>& d,
+                     vector<int>& firstHop, vector<pair<long long, int>>& heap) const {
+        greater<pair<long long, int>> minFirst;
+        fill(d.begin(), d.end(), UNREACHABLE);
+        fill(firstHop.begin(), firstHop.end(), -1);
+        heap.clear();
+        d[s] = 0;
+        heap.push_back(make_pair(0LL, s));
+        // Shortest cycle back to s; reduced and real cycle costs are equal
+        long long cycle = UNREACHABLE;
+        int cycleHop = -1;
+
+        while (!heap.empty()) {
+            pop_heap(heap.begin(), heap.end(), minFirst);
+            long long du = heap.back().first;
+            int u = heap.back().second;
+            heap.pop_back();
+            if (du != d[u]) continue; // stale entry
+
+            for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                int v = targets[e];
+                if (v == s && du + costs[e] < cycle) {
+                    cycle = du + costs[e];
+                    cycleHop = firstHop[u];
+                }
+                if (du + costs[e] < d[v]) {
+                    d[v] = du + costs[e];
+                    firstHop[v] = (u == s) ? v : firstHop[u];
+                    heap.push_back(make_pair(d[v], v));
+                    push_heap(heap.begin(), heap.end(), minFirst);
+                }
+            }
+        }
+
+        long long* distRow = dist.rowData(s);
+        int* nextRow = next.rowData(s);
+        for (int v = 0; v < V; v++) {
+            distRow[v] = (d[v] == UNREACHABLE) ? UNREACHABLE : d[v] - h[s] + h[v];
+            nextRow[v] = firstHop[v];
+        }
+
+        // The diagonal as Floyd-Warshall leaves it: the self-loop weight
+        // (UNREACHABLE without one), lowered by any shorter cycle through s
+        distRow[s] = loops[s];
+        nextRow[s] = -1;
+        if (cycle < loops[s]) {
+            distRow[s] = cycle;
+            nextRow[s] = cycleHop;
+        }
+    }
+
+public:
+    // Reads the edges (i != j, weight != UNREACHABLE) of an adjacency matrix;
+    // the diagonal is kept apart, only to seed dist[i][i].
+    explicit Johnson(const DistMatrix& weight)
+        : V(weight.size()), offsets(weight.size() + 1, 0), loops(weight.size()) {
+        for (int i = 0; i < V; i++) {
+            const long long* row = weight.rowData(i);
+            loops[i] = row[i];
+            for (int j = 0; j < V; j++) {
+                if (i != j && row[j] != UNREACHABLE) {
+                    targets.push_back(j);
+                    costs.push_back(row[j]);
+                }
+            }
+            offsets[i + 1] = targets.size();
+        }
+    }
+
+    // Returns false (leaving dist/next untouched) if there is a negative cycle.
+    bool run(DistMatrix& dist, NextMatrix& next, int workers) {
+        for (int i = 0; i < V; i++) {
+            if (loops[i] < 0) return false; // negative self-loop
+        }
+        if (!computePotentials()) {
+            return false;
+        }
+        for (int u = 0; u < V; u++) {
+            for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                costs[e] += h[u] - h[targets[e]];
+            }
+        }
+
+        atomic<int> nextSource(0);
+        runWorkers(workers, [&](int) {
+            vector<long long> d(V);
+            vector<int> firstHop(V);
+            vector<pair<long long, int>> heap;
+            for (int s = nextSource++; s < V; s = nextSource++) {
+                dijkstraRow(s, dist, next, d, firstHop, heap);
+            }
+        });
+        return true;
+    }
+};
+
+// Saved FloydWarshall result: this header, then dist (int64, UNREACHABLE for
+// no path) and next (uint16 when V < 65536, otherwise uint32; all ones means no
+// next hop). Both matrices have 64-byte padded rows and start on a 64-byte
+// boundary, so a mapped snapshot's dist is used in place.
+const char SNAPSHOT_MAGIC[8] = {'A', 'P', 'S', 'P', 'S', 'N', 'A', 'P'};
+const uint32_t SNAPSHOT_VERSION = 1;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t nextWidth;   // bytes per next entry: 2 or 4
+    uint64_t vertices;
+    uint64_t distStride;  // elements per dist row
+    uint64_t nextStride;  // elements per next row
+    uint64_t distOffset;
+    uint64_t nextOffset;
+    uint64_t edgeCount;
+};
+static_assert(sizeof(SnapshotHeader) == 64, "snapshot header must stay 64 bytes");
+
+// One edge change for FloydWarshall::applyEdgeUpdates; w == INF removes the edge.
+struct EdgeUpdate {
+    int u, v;
+    long long w;
+};
+
+enum Engine { ENGINE_AUTO, ENGINE_FLOYD_WARSHALL, ENGINE_JOHNSON };
+
+// Johnson is preferred when E log V is well below V^2: the vectorized
+// Floyd-Warshall does about V^3 / lanes cheap operations, while each heap
+// operation in Dijkstra costs far more than one min-plus lane.
+const double JOHNSON_DENSITY_FACTOR = 8.0;
+
 class FloydWarshall {
 private:
+    enum WalkState { UNSEEN, ON_WALK, GOOD, BAD };
+
     int V;
-    vector<vector<long long>> dist;
-    vector<vector<int>> next;
+    int tileSize; // 0 selects the classic k-i-j loop, otherwise the blocked kernel
+    int threadCount;
+    Engine engine;
+    long long edgeCount; // i != j entries of weight that are not INF
+    // INF from the input is stored as UNREACHABLE in both matrices
+    DistMatrix weight; // original edge weights, kept for path repair and updates
+    DistMatrix dist;
+    NextMatrix next;
+    RelaxRowFn relaxRow;
+    const char* kernelName;
+
+    // Relax every (i, j) in the tile [i0,i1) x [j0,j1) through each k in [k0,k1).
+    // The same next[i][j] = next[i][k] update as the classic loop keeps paths intact.
+    void relaxTile(int i0, int i1, int j0, int j1, int k0, int k1) {
+        for (int k = k0; k < k1; k++) {
+            const long long* dk = dist.rowData(k);
+            for (int i = i0; i < i1; i++) {
+                long long* di = dist.rowData(i);
+                int* ni = next.rowData(i);
+                if (isUnreachable(di[k])) continue;
+                relaxRow(di, dk, ni, di[k], ni[k], j0, j1);
+            }
+        }
+    }
+
+    // Rows are split into one contiguous band per worker, with a single barrier
+    // per k. Row k is read by every worker while its owner may write it, so the
+    // owner publishes a copy into a double-buffered pivot before the barrier.
+    void computeClassic(int workers) {
+        Barrier barrier(workers);
+        vector<long long> pivot[2] = {vector<long long>(V), vector<long long>(V)};
+        copy(dist.rowData(0), dist.rowData(0) + V, pivot[0].begin());
+
+        runWorkers(workers, [&](int w) {
+            int lo = (int)((long long)V * w / workers);
+            int hi = (int)((long long)V * (w + 1) / workers);
+            for (int k = 0; k < V; k++) {
+                const long long* dk = pivot[k & 1].data();
+                for (int i = lo; i < hi; i++) {
+                    long long* di = dist.rowData(i);
+                    int* ni = next.rowData(i);
+                    // A whole row is skipped when i cannot reach k; the per-j INF test is
+                    // unnecessary thanks to the UNREACHABLE encoding.
+                    if (isUnreachable(di[k])) continue;
+                    relaxRow(di, dk, ni, di[k], ni[k], 0, V);
+                }
+                if (k + 1 < V && k + 1 >= lo && k + 1 < hi) {
+                    const long long* row = dist.rowData(k + 1);
+                    copy(row, row + V, pivot[(k + 1) & 1].begin());
+                }
+                barrier.wait();
+            }
+        });
+    }
+
+    // Fold drifted "no path" values back to UNREACHABLE and clear their next hop.
+    void normalizeUnreachable() {
+        for (int i = 0; i < V; i++) {
+            long long* di = dist.rowData(i);
+            int* ni = next.rowData(i);
+            for (int j = 0; j < V; j++) {
+                if (isUnreachable(di[j])) {
+                    di[j] = UNREACHABLE;
+                    ni[j] = -1;
+                }
+            }
+        }
+    }
+
+    // Three-phase blocked Floyd-Warshall: for each diagonal tile kb, first close the
+    // tile itself, then the tiles in its row and column, then every remaining tile.
+    // Each phase only reads tiles finished by an earlier phase, so a T x T working
+    // set stays in cache instead of streaming the whole matrix per k. Tiles within
+    // phases 2 and 3 are independent and are dealt round-robin to the workers.
+    void computeBlocked(int workers) {
+        int T = tileSize;
+        int others = (V + T - 1) / T - 1; // tiles per row besides the diagonal one
+        Barrier barrier(workers);
+
+        runWorkers(workers, [&](int w) {
+            for (int kb = 0; kb < V; kb += T) {
+                int kEnd = min(kb + T, V);
+                int kIndex = kb / T;
+
+                // Phase 1: diagonal tile
+                if (w == 0) {
+                    relaxTile(kb, kEnd, kb, kEnd, kb, kEnd);
+                }
+                barrier.wait();
+
+                // Phase 2: tiles sharing the diagonal tile's row or column
+                for (int t = w; t < 2 * others; t += workers) {
+                    int index = t % others;
+                    int b = (index < kIndex ? index : index + 1) * T;
+                    int bEnd = min(b + T, V);
+                    if (t < others) {
+                        relaxTile(kb, kEnd, b, bEnd, kb, kEnd);
+                    } else {
+                        relaxTile(b, bEnd, kb, kEnd, kb, kEnd);
+                    }
+                }
+                barrier.wait();
+
+                // Phase 3: all remaining tiles
+                for (int t = w; t < others * others; t += workers) {
+                    int ib = t / others, jb = t % others;
+                    ib = (ib < kIndex ? ib : ib + 1) * T;
+                    jb = (jb < kIndex ? jb : jb + 1) * T;
+                    relaxTile(ib, min(ib + T, V), jb, min(jb + T, V), kb, kEnd);
+                }
+                barrier.wait();
+            }
+        });
+    }
+
+    // Sort the reachable nodes of column j by where their next-hop walk ends:
+    // GOOD walks reach j, BAD walks run into a loop. Nodes that lie on a loop are
+    // collected in `loops`, every other BAD node in `bad`.
+    void classifyColumn(int j, vector<char>& state, vector<int>& loops, vector<int>& bad) {
+        fill(state.begin(), state.end(), (char)UNSEEN);
+        state[j] = GOOD;
+        loops.clear();
+        bad.clear();
+        for (int s = 0; s < V; s++) {
+            if (state[s] != UNSEEN || dist[s][j] == UNREACHABLE) continue;
+            int c = s;
+            while (state[c] == UNSEEN) {
+                state[c] = ON_WALK;
+                c = next[c][j];
+            }
+            char outcome = (state[c] == GOOD) ? GOOD : BAD;
+            int loopStart = (state[c] == ON_WALK) ? c : -1;
+            bool onLoop = false;
+            for (int w = s; state[w] == ON_WALK; w = next[w][j]) {
+                if (w == loopStart) onLoop = true;
+                state[w] = outcome;
+                if (outcome == BAD) (onLoop ? loops : bad).push_back(w);
+            }
+        }
+    }
+
+    // Re-point each listed node whose row has a tight edge into a GOOD node.
+    bool pointToGood(int j, const vector<int>& nodes, const vector<long long>& column,
+                     vector<char>& state) {
+        bool fixedAny = false;
+        for (int i : nodes) {
+            const long long* wi = weight.rowData(i);
+            for (int a = 0; a < V; a++) {
+                if (wi[a] + column[a] == column[i] && wi[a] != UNREACHABLE && a != i && state[a] == GOOD) {
+                    next[i][j] = a;
+                    state[i] = GOOD;
+                    fixedAny = true;
+                    break;
+                }
+            }
+        }
+        return fixedAny;
+    }
+
+    // The blocked schedule relaxes through k using d[i][k] values that may already
+    // route through later k' of the same tile. Distances stay exact and every next
+    // hop stays on a tight edge, but on a zero-weight cycle the first-hop pointers
+    // of a column can close into a loop. Each column is checked in O(V); a broken
+    // one gets its loop nodes re-pointed along a tight edge
+    // (weight[i][a] + dist[a][j] == dist[i][j]) to a node known to reach j, which
+    // also heals every walk that fed into the loop.
+    void repairNextColumns() {
+        vector<char> state(V);
+        vector<int> loops, bad;
+        vector<long long> column(V);
+        for (int j = 0; j < V; j++) {
+            classifyColumn(j, state, loops, bad);
+            if (loops.empty()) continue;
+
+            for (int a = 0; a < V; a++) column[a] = dist[a][j];
+            while (!loops.empty()) {
+                // Some BAD node always has a tight edge into a GOOD one (the last BAD
+                // node on its shortest path), so the fallback guarantees progress.
+                if (!pointToGood(j, loops, column, state) && !pointToGood(j, bad, column, state)) {
+                    break;
+                }
+                classifyColumn(j, state, loops, bad);
+            }
+        }
+    }
+
+    // Lower (or insert) edge u -> v to w in O(V^2): every pair can only improve by
+    // routing i ~> u -> v ~> j, which is one min-plus row relaxation per source i
+    // with row v as the pivot. Row v and column u cannot change without a negative
+    // cycle, so they are safe to read while relaxing.
+    bool applyDecrease(int u, int v, long long w) {
+        if (dist[v][u] != UNREACHABLE && w + dist[v][u] < 0) {
+            return false; // would close a negative cycle
+        }
+        if (weight[u][v] == UNREACHABLE) edgeCount++;
+        weight[u][v] = w;
+        if (w >= dist[u][v]) return true;
+
+        // dist[x][x] holds a self-loop or cycle length rather than 0, so the walk
+        // to v itself is relaxed separately, and row u starts from u at distance 0
+        const long long* dv = dist.rowData(v);
+        for (int i = 0; i < V; i++) {
+            long long* di = dist.rowData(i);
+            long long toU = (i == u) ? 0 : di[u];
+            if (toU == UNREACHABLE) continue;
+            int hop = (i == u) ? v : next[i][u];
+            relaxRow(di, dv, next.rowData(i), toU + w, hop, 0, V);
+            if (toU + w < di[v]) {
+                di[v] = toU + w;
+                next[i][v] = hop;
+            }
+        }
+        normalizeUnreachable();
+        return true;
+    }
+
+    // Recompute row s after edge weights went up, with a dense O(V^2) Dijkstra.
+    // The old row is a valid potential: old weights satisfy
+    // w(a,b) + old[a] - old[b] >= 0 and raising weights keeps that true, so the
+    // reduced costs are non-negative even with negative edges. Vertices the old
+    // row could not reach stay unreachable. The old diagonal entry is a cycle
+    // length, not a distance, so s itself gets potential 0; dist[s][s] is then
+    // rebuilt like Floyd-Warshall does from the self-loop and the shortest cycle.
+    void recomputeRow(int s, vector<long long>& h, vector<long long>& d,
+                      vector<int>& firstHop, vector<char>& done) {
+        long long* distRow = dist.rowData(s);
+        copy(distRow, distRow + V, h.begin());
+        h[s] = 0;
+        long long cycle = UNREACHABLE;
+        int cycleHop = -1;
+        fill(d.begin(), d.end(), UNREACHABLE);
+        fill(firstHop.begin(), firstHop.end(), -1);
+        fill(done.begin(), done.end(), 0);
+        d[s] = 0;
+
+        while (true) {
+            int u = -1;
+            for (int x = 0; x < V; x++) {
+                if (!done[x] && d[x] != UNREACHABLE && (u < 0 || d[x] < d[u])) u = x;
+            }
+            if (u < 0) break;
+            done[u] = 1;
+
+            const long long* wu = weight.rowData(u);
+            if (u != s && wu[s] != UNREACHABLE && d[u] + wu[s] + h[u] < cycle) {
+                cycle = d[u] + wu[s] + h[u];
+                cycleHop = firstHop[u];
+            }
+            for (int x = 0; x < V; x++) {
+                if (done[x] || wu[x] == UNREACHABLE || x == u || h[x] == UNREACHABLE) continue;
+                long long cand = d[u] + wu[x] + h[u] - h[x];
+                if (cand < d[x]) {
+                    d[x] = cand;
+                    firstHop[x] = (u == s) ? x : firstHop[u];
+                }
+            }
+        }
+
+        int* nextRow = next.rowData(s);
+        for (int x = 0; x < V; x++) {
+            distRow[x] = (d[x] == UNREACHABLE) ? UNREACHABLE : d[x] - h[s] + h[x];
+            nextRow[x] = firstHop[x];
+        }
+        distRow[s] = weight[s][s];
+        nextRow[s] = -1;
+        if (cycle < distRow[s]) {
+            distRow[s] = cycle;
+            nextRow[s] = cycleHop;
+        }
+    }
 
 public:
-    FloydWarshall(int vertices) : V(vertices) {
-        dist.resize(V, vector<long long>(V, INF));
-        next.resize(V, vector<int>(V, -1));
+    FloydWarshall(int vertices)
+        : V(vertices), tileSize(0), threadCount(1), engine(ENGINE_AUTO), edgeCount(0), weight(vertices, UNREACHABLE), dist(vertices, UNREACHABLE), next(vertices, -1) {
+        relaxRow = selectRelaxRow(&kernelName);
+    }
+
+    // Take over already-encoded matrices (UNREACHABLE = no edge) without copying,
+    // e.g. two private mappings of the same binary matrix file. Only next is built.
+    FloydWarshall(DistMatrix&& graph, DistMatrix&& workingCopy)
+        : V(graph.size()), tileSize(0), threadCount(1), engine(ENGINE_AUTO), edgeCount(0),
+          weight(move(graph)), dist(move(workingCopy)), next(V, -1) {
+        relaxRow = selectRelaxRow(&kernelName);
+        for (int i = 0; i < V; i++) {
+            const long long* src = weight.rowData(i);
+            int* nextRow = next.rowData(i);
+            for (int j = 0; j < V; j++) {
+                nextRow[j] = (i != j && src[j] != UNREACHABLE) ? j : -1;
+                edgeCount += (nextRow[j] != -1);
+            }
+        }
+    }
+
+    // Query-only instance over a loaded snapshot. There is no weight matrix, so
+    // it must not be recomputed or have edges updated.
+    FloydWarshall(DistMatrix&& distances, NextMatrix&& hops, long long edges)
+        : V(distances.size()), tileSize(0), threadCount(1), engine(ENGINE_AUTO), edgeCount(edges),
+          weight(0, UNREACHABLE), dist(move(distances)), next(move(hops)) {
+        relaxRow = selectRelaxRow(&kernelName);
     }
 
     void inputGraph() {
@@ -26,50 +696,87 @@ public:
         cout << "Enter adjacency matrix (use " << INF << " for infinity):" << endl;
         cout << "Format: Enter " << V << " rows with " << V << " values each" << endl;
         
+        edgeCount = 0;
         for (int i = 0; i < V; i++) {
             cout << "Row " << i << ": ";
+            RowView<long long> distRow = dist[i];
+            RowView<int> nextRow = next[i];
             for (int j = 0; j < V; j++) {
-                long long weight;
-                cin >> weight;
-                dist[i][j] = weight;
-                if (i != j && weight != INF) {
-                    next[i][j] = j;
-                }
+                long long w;
+                cin >> w;
+                distRow[j] = (w == INF) ? UNREACHABLE : w;
+                weight[i][j] = distRow[j];
+                nextRow[j] = (i != j && w != INF) ? j : -1;
+                edgeCount += (nextRow[j] != -1);
             }
         }
     }
 
-    void setGraph(const vector<vector<long long>>& graph) {
+    void setGraph(const DistMatrix& graph) {
+        edgeCount = 0;
         for (int i = 0; i < V; i++) {
+            const long long* src = graph.rowData(i);
+            // next[i][j] is used to reconstruct the path. 
+            // If there's a direct edge (weight != INF and i != j), the next stop is j;
+            // otherwise next remains -1.
+            long long* distRow = dist.rowData(i);
+            int* nextRow = next.rowData(i);
             for (int j = 0; j < V; j++) {
-                dist[i][j] = graph[i][j];
-                // next[i][j] is used to reconstruct the path. 
-                // If there's a direct edge (weight != INF and i != j), the next stop is j.
-                if (i != j && graph[i][j] != INF) {
-                    next[i][j] = j;
-                }
-                // Handle the case where there is no direct edge, ensuring next remains -1 unless an edge exists
-                else if (i != j && graph[i][j] == INF) {
-                    next[i][j] = -1; 
-                }
+                distRow[j] = (src[j] == INF) ? UNREACHABLE : src[j];
+                nextRow[j] = (i != j && src[j] != INF) ? j : -1;
+                edgeCount += (nextRow[j] != -1);
             }
+            memcpy(weight.rowData(i), distRow, V * sizeof(long long));
+        }
+    }
+
+    // Tile edge length for the blocked kernel; 0 keeps the classic triple loop.
+    void setTileSize(int size) {
+        tileSize = max(0, size);
+    }
+
+    // Number of worker threads used by computeShortestPaths (1 = run serially).
+    void setThreadCount(int count) {
+        threadCount = max(1, count);
+    }
+
+    // ENGINE_AUTO picks Johnson or Floyd-Warshall from the edge density.
+    void setEngine(Engine e) {
+        engine = e;
+    }
+
+    long long getEdgeCount() const { return edgeCount; }
+
+    bool usesJohnson() const {
+        if (engine != ENGINE_AUTO) {
+            return engine == ENGINE_JOHNSON;
         }
+        return edgeCount * log2((double)V + 1) * JOHNSON_DENSITY_FACTOR < (double)V * V;
     }
 
+    const char* getKernelName() const { return kernelName; }
+
+    // Shortest distance from i to j after computeShortestPaths; UNREACHABLE if none.
+    long long getDistance(int i, int j) const { return dist[i][j]; }
+
+    // First hop on the shortest path from i to j; -1 if there is none.
+    int getNextHop(int i, int j) const { return next[i][j]; }
+
     bool computeShortestPaths() {
+        int workers = min(threadCount, max(1, V));
+        if (usesJohnson()) {
+            Johnson johnson(weight);
+            return johnson.run(dist, next, workers);
+        }
+
         // Floyd-Warshall Algorithm
-        for (int k = 0; k < V; k++) {
-            for (int i = 0; i < V; i++) {
-                for (int j = 0; j < V; j++) {
-                    // Check for overflow before addition (INF + anything is problematic)
-                    if (dist[i][k] != INF && dist[k][j] != INF) {
-                        if (dist[i][k] + dist[k][j] < dist[i][j]) {
-                            dist[i][j] = dist[i][k] + dist[k][j];
-                            next[i][j] = next[i][k];
-                        }
-                    }
-                }
-            }
+        if (tileSize > 0 && tileSize < V) {
+            computeBlocked(workers);
+            normalizeUnreachable();
+            repairNextColumns();
+        } else {
+            computeClassic(workers);
+            normalizeUnreachable();
         }
 
         // Check for negative cycles
@@ -81,6 +788,85 @@ public:
         return true;
     }
 
+    // Change edge u -> v to weight w (INF removes it) and repair dist/next
+    // without a full recomputation. Requires a successful computeShortestPaths.
+    // Returns false with `error` set if the edge is invalid or the change would
+    // create a negative cycle; it is then ignored.
+    bool updateEdge(int u, int v, long long w, string& error) {
+        return applyEdgeUpdates(vector<EdgeUpdate>(1, EdgeUpdate{u, v, w}), error);
+    }
+
+    // Batched form of updateEdge; for repeated (u, v) the last weight wins.
+    // All increases and removals are applied first: only source rows in which
+    // one of those edges was tight (dist[i][u] + old == dist[i][v]) can change,
+    // and each of them is recomputed once. Decreases then follow one by one in
+    // O(V^2) each. An update with an invalid vertex or u == v rejects the whole
+    // batch before anything changes. Returns false with `error` set if the batch
+    // was rejected or any decrease was.
+    bool applyEdgeUpdates(const vector<EdgeUpdate>& updates, string& error) {
+        for (size_t k = 0; k < updates.size(); k++) {
+            const EdgeUpdate& e = updates[k];
+            if (e.u < 0 || e.u >= V || e.v < 0 || e.v >= V) {
+                error = "Invalid vertex in update " + to_string(k + 1) + ".";
+                return false;
+            }
+            if (e.u == e.v) {
+                error = "Update " + to_string(k + 1) + " is a self-loop; only edges between two vertices can be updated.";
+                return false;
+            }
+        }
+
+        map<pair<int, int>, long long> latest;
+        for (const EdgeUpdate& e : updates) {
+            latest[make_pair(e.u, e.v)] = (e.w == INF) ? UNREACHABLE : e.w;
+        }
+
+        vector<char> affected(V, 0);
+        bool anyAffected = false;
+        for (const auto& entry : latest) {
+            int u = entry.first.first, v = entry.first.second;
+            long long oldW = weight[u][v];
+            if (entry.second <= oldW || oldW == UNREACHABLE) continue;
+            for (int i = 0; i < V; i++) {
+                long long toU = (i == u) ? 0 : dist[i][u];
+                if (toU != UNREACHABLE && toU + oldW == dist[i][v]) {
+                    affected[i] = 1;
+                    anyAffected = true;
+                }
+            }
+        }
+        for (const auto& entry : latest) {
+            int u = entry.first.first, v = entry.first.second;
+            if (entry.second > weight[u][v]) {
+                if (entry.second == UNREACHABLE) edgeCount--;
+                weight[u][v] = entry.second;
+            }
+        }
+
+        if (anyAffected) {
+            atomic<int> nextRow(0);
+            runWorkers(min(threadCount, V), [&](int) {
+                vector<long long> h(V), d(V);
+                vector<int> firstHop(V);
+                vector<char> done(V);
+                for (int s = nextRow++; s < V; s = nextRow++) {
+                    if (affected[s]) recomputeRow(s, h, d, firstHop, done);
+                }
+            });
+        }
+
+        bool allApplied = true;
+        for (const auto& entry : latest) {
+            int u = entry.first.first, v = entry.first.second;
+            if (entry.second < weight[u][v] && !applyDecrease(u, v, entry.second)) {
+                error = "Edge " + to_string(u) + " -> " + to_string(v) +
+                        " would create a **negative weight cycle**; it was not changed.";
+                allApplied = false;
+            }
+        }
+        return allApplied;
+    }
+
     void printDistanceMatrix() {
         cout << "\n=== All-to-All Shortest Distances ===" << endl;
         cout << "     ";
@@ -93,7 +879,7 @@ public:
         for (int i = 0; i < V; i++) {
             cout << "V" << i << " | ";
             for (int j = 0; j < V; j++) {
-                if (dist[i][j] == INF) {
+                if (dist[i][j] == UNREACHABLE) {
                     cout << setw(8) << "INF";
                 } else {
                     cout << setw(8) << dist[i][j];
@@ -103,39 +889,72 @@ public:
         }
     }
 
-    void printPath(int start, int end) {
-        if (dist[start][end] == INF) {
-            cout << "No path exists from V" << start << " to V" << end << endl;
+    // Append the printPath() line for (start, end) to `out`. `path` is scratch
+    // space the caller can reuse across calls, so a batch allocates nothing per query.
+    void formatPath(int start, int end, vector<int>& path, string& out) const {
+        char num[24];
+        auto appendInt = [&](long long x) {
+            out.append(num, to_chars(num, num + sizeof(num), x).ptr);
+        };
+
+        long long d = dist.rowData(start)[end];
+        if (d == UNREACHABLE) {
+            out += "No path exists from V";
+            appendInt(start);
+            out += " to V";
+            appendInt(end);
+            out += '\n';
             return;
         }
 
-        vector<int> path;
+        path.clear();
         int current = start;
         path.push_back(current);
 
-        // Path reconstruction using the next matrix
+        // Path reconstruction walks column `end` of the next matrix, one row per hop
+        const int* nextBase = next.rowData(0);
+        size_t stride = next.stride();
+        // A simple path has at most V - 1 hops; more means next holds a cycle
         while (current != end) {
-            current = next[current][end];
-            if (current == -1) { // Should not happen if dist[start][end] != INF, but good safeguard
-                cout << "Error: Path reconstruction failed from V" << start << " to V" << end << endl;
+            current = nextBase[(size_t)current * stride + end];
+            if (current == -1 || (int)path.size() >= V) { // Should not happen for a reachable pair, but good safeguard
+                out += "Error: Path reconstruction failed from V";
+                appendInt(start);
+                out += " to V";
+                appendInt(end);
+                out += '\n';
                 return;
             }
             path.push_back(current);
         }
 
-        cout << "Path from V" << start << " to V" << end << " (Distance: " << dist[start][end] << "): ";
+        out += "Path from V";
+        appendInt(start);
+        out += " to V";
+        appendInt(end);
+        out += " (Distance: ";
+        appendInt(d);
+        out += "): ";
         for (size_t i = 0; i < path.size(); i++) {
-            cout << "V" << path[i];
-            if (i < path.size() - 1) cout << " -> ";
+            out += 'V';
+            appendInt(path[i]);
+            if (i < path.size() - 1) out += " -> ";
         }
-        cout << endl;
+        out += '\n';
+    }
+
+    void printPath(int start, int end) {
+        vector<int> path;
+        string line;
+        formatPath(start, end, path, line);
+        cout << line << flush;
     }
 
     void printAllPaths() {
         cout << "\n=== All Shortest Paths ===" << endl;
         for (int i = 0; i < V; i++) {
             for (int j = 0; j < V; j++) {
-                if (i != j && dist[i][j] != INF) {
+                if (i != j && dist[i][j] != UNREACHABLE) {
                     printPath(i, j);
                 }
             }
@@ -156,25 +975,229 @@ public:
 
         printPath(start, end);
     }
+
+    // Answer every "src dst" pair in queryFile, writing one printPath() line per
+    // pair to outputFile in input order. Workers format alternating chunks of
+    // the queries into their own reusable buffers; worker 0 writes the chunks out
+    // in order with one fwrite each. Returns the number of pairs answered, or -1
+    // with `error` set.
+    long long answerQueries(const string& queryFile, const string& outputFile, string& error) {
+        MappedFile map;
+        vector<int> pairs;
+        if (map.open(queryFile, false)) {
+            const char* p = map.data();
+            const char* end = p + map.size();
+            while (true) {
+                while (p < end && isspace((unsigned char)*p)) p++;
+                if (p == end) break;
+                int vertex;
+                auto parsed = from_chars(p, end, vertex);
+                if (parsed.ec != errc()) {
+                    error = "Invalid vertex in query " + to_string(pairs.size() / 2 + 1) + ".";
+                    return -1;
+                }
+                pairs.push_back(vertex);
+                p = parsed.ptr;
+            }
+        } else {
+            FILE* probe = fopen(queryFile.c_str(), "rb");
+            if (probe == nullptr) {
+                error = "Could not open file: " + queryFile;
+                return -1;
+            }
+            fclose(probe); // empty file: no queries
+        }
+        if (pairs.size() % 2 != 0) {
+            error = "Query " + to_string(pairs.size() / 2 + 1) + " has no destination vertex.";
+            return -1;
+        }
+
+        FILE* out = fopen(outputFile.c_str(), "wb");
+        if (out == nullptr) {
+            error = "Could not create file: " + outputFile;
+            return -1;
+        }
+
+        const long long CHUNK = 8192;
+        long long queries = pairs.size() / 2;
+        int workers = (int)min<long long>(threadCount, max(1LL, (queries + CHUNK - 1) / CHUNK));
+        long long rounds = (queries + CHUNK * workers - 1) / (CHUNK * workers);
+        vector<string> buffers(workers);
+        Barrier barrier(workers);
+        bool writeFailed = false;
+
+        runWorkers(workers, [&](int w) {
+            vector<int> path;
+            string& buffer = buffers[w];
+            for (long long r = 0; r < rounds; r++) {
+                buffer.clear();
+                long long lo = (r * workers + w) * CHUNK;
+                long long hi = min(queries, lo + CHUNK);
+                for (long long q = lo; q < hi; q++) {
+                    int start = pairs[2 * q], end = pairs[2 * q + 1];
+                    if (start < 0 || start >= V || end < 0 || end >= V) {
+                        buffer += "Invalid vertices: " + to_string(start) + " " + to_string(end) + "\n";
+                    } else {
+                        formatPath(start, end, path, buffer);
+                    }
+                }
+                barrier.wait();
+                if (w == 0) {
+                    for (const string& chunk : buffers) {
+                        if (fwrite(chunk.data(), 1, chunk.size(), out) != chunk.size()) {
+                            writeFailed = true;
+                        }
+                    }
+                }
+                barrier.wait();
+            }
+        });
+
+        if (fclose(out) != 0 || writeFailed) {
+            error = "Could not write file: " + outputFile;
+            return -1;
+        }
+        return queries;
+    }
+
+    // Write dist and next as a snapshot (see SnapshotHeader).
+    bool saveSnapshot(const string& path, string& error) const {
+        SnapshotHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+        header.version = SNAPSHOT_VERSION;
+        header.nextWidth = (V < 65536) ? 2 : 4;
+        header.vertices = V;
+        header.distStride = dist.stride();
+        size_t perLine = DistMatrix::ALIGNMENT / header.nextWidth;
+        header.nextStride = (V + perLine - 1) / perLine * perLine;
+        header.distOffset = sizeof(header);
+        header.nextOffset = header.distOffset + (uint64_t)V * header.distStride * sizeof(long long);
+        header.edgeCount = edgeCount;
+
+        FILE* out = fopen(path.c_str(), "wb");
+        if (out == nullptr) {
+            error = "Could not create file: " + path;
+            return false;
+        }
+        // dist rows are already 64-byte padded and contiguous
+        bool ok = fwrite(&header, sizeof(header), 1, out) == 1 &&
+                  fwrite(dist.rowData(0), sizeof(long long), (size_t)V * header.distStride, out) ==
+                      (size_t)V * header.distStride;
+
+        vector<char> row(header.nextStride * header.nextWidth);
+        for (int i = 0; i < V && ok; i++) {
+            const int* src = next.rowData(i);
+            if (header.nextWidth == 2) {
+                uint16_t* dst = reinterpret_cast<uint16_t*>(row.data());
+                for (int j = 0; j < V; j++) dst[j] = (uint16_t)src[j]; // -1 becomes 0xFFFF
+                fill(dst + V, dst + header.nextStride, (uint16_t)0xFFFF);
+            } else {
+                uint32_t* dst = reinterpret_cast<uint32_t*>(row.data());
+                for (int j = 0; j < V; j++) dst[j] = (uint32_t)src[j];
+                fill(dst + V, dst + header.nextStride, (uint32_t)0xFFFFFFFF);
+            }
+            ok = fwrite(row.data(), 1, row.size(), out) == row.size();
+        }
+
+        if (fclose(out) != 0 || !ok) {
+            error = "Could not write file: " + path;
+            remove(path.c_str());
+            return false;
+        }
+        return true;
+    }
 };
 
-void runFloydWarshall(FloydWarshall& fw) {
-    cout << "\nComputing shortest paths..." << endl;
-    if (fw.computeShortestPaths()) {
-        fw.printDistanceMatrix();
-        
-        char choice;
-        cout << "\nDo you want to see all paths? (y/n): ";
+// Show the computed distances and answer path queries; shared by a fresh
+// computation and a loaded snapshot.
+void exploreResults(FloydWarshall& fw) {
+    fw.printDistanceMatrix();
+    
+    char choice;
+    cout << "\nDo you want to see all paths? (y/n): ";
+    cin >> choice;
+    if (choice == 'y' || choice == 'Y') {
+        fw.printAllPaths();
+    }
+
+    while (true) {
+        cout << "\nQuery specific path? (y/n): ";
         cin >> choice;
-        if (choice == 'y' || choice == 'Y') {
-            fw.printAllPaths();
+        if (choice != 'y' && choice != 'Y') break;
+        fw.queryPath();
+    }
+
+    cout << "\nAnswer a batch of queries from a file? (y/n): ";
+    cin >> choice;
+    if (choice == 'y' || choice == 'Y') {
+        string queryFile, outputFile;
+        cout << "Query file (one \"source destination\" pair per line): ";
+        cin >> queryFile;
+        cout << "Output file: ";
+        cin >> outputFile;
+        string error;
+        long long answered = fw.answerQueries(queryFile, outputFile, error);
+        if (answered < 0) {
+            cout << "**Error:** " << error << endl;
+        } else {
+            cout << "Answered " << answered << " queries into " << outputFile << endl;
         }
+    }
+}
+
+void runFloydWarshall(FloydWarshall& fw) {
+    int tile;
+    cout << "\nTile size for blocked kernel (0 = classic loop, e.g. 64): ";
+    if (cin >> tile && tile > 0) {
+        fw.setTileSize(tile);
+    }
+
+    int threads;
+    cout << "Worker threads (1 = single-threaded, this machine has "
+         << thread::hardware_concurrency() << "): ";
+    if (cin >> threads && threads > 1) {
+        fw.setThreadCount(threads);
+    }
 
+    cout << "\nGraph has " << fw.getEdgeCount() << " edges." << endl;
+    if (fw.usesJohnson()) {
+        cout << "Computing shortest paths (sparse graph: Johnson's algorithm)..." << endl;
+    } else {
+        cout << "Computing shortest paths (Floyd-Warshall, " << fw.getKernelName()
+             << " min-plus kernel)..." << endl;
+    }
+    if (fw.computeShortestPaths()) {
+        exploreResults(fw);
+
+        char choice;
         while (true) {
-            cout << "\nQuery specific path? (y/n): ";
+            cout << "\nUpdate an edge weight? (y/n): ";
             cin >> choice;
             if (choice != 'y' && choice != 'Y') break;
-            fw.queryPath();
+            int u, v;
+            long long w;
+            cout << "Enter source, destination and new weight (" << INF << " removes the edge): ";
+            if (!(cin >> u >> v >> w)) break;
+            string error;
+            if (fw.updateEdge(u, v, w, error)) {
+                fw.printDistanceMatrix();
+            } else {
+                cout << "Rejected: " << error << endl;
+            }
+        }
+
+        cout << "\nSave the result as a snapshot? (y/n): ";
+        cin >> choice;
+        if (choice == 'y' || choice == 'Y') {
+            string filename, error;
+            cout << "Snapshot filename (e.g., graph.apsp): ";
+            cin >> filename;
+            if (fw.saveSnapshot(filename, error)) {
+                cout << "Snapshot written to " << filename << endl;
+            } else {
+                cout << "**Error:** " << error << endl;
+            }
         }
     } else {
         cout << "Graph contains a **negative weight cycle**!" << endl;
@@ -182,7 +1205,7 @@ void runFloydWarshall(FloydWarshall& fw) {
 }
 
 void usePredefinedGraph() {
-    vector<vector<long long>> graph = {
+    DistMatrix graph = DistMatrix::fromRows({
         {0, 3, 8, INF, -4, INF, INF, INF},
         {INF, 0, INF, 1, 7, INF, INF, INF},
         {INF, 4, 0, INF, INF, INF, 2, INF},
@@ -191,7 +1214,7 @@ void usePredefinedGraph() {
         {INF, INF, INF, INF, INF, 0, 1, 8},
         {INF, INF, 3, INF, INF, INF, 0, -2},
         {INF, INF, INF, INF, INF, INF, INF, 0}
-    };
+    }, INF);
 
     int V = graph.size();
     FloydWarshall fw(V);
@@ -212,52 +1235,197 @@ void useCustomGraph() {
     runFloydWarshall(fw);
 }
 
+// Hand the rows of a mapped int64 matrix file over to a DistMatrix; the mapping
+// is released when the matrix goes away.
+DistMatrix adoptMappedMatrix(MappedFile& map, const MatrixFileHeader& header) {
+    long long* rows = reinterpret_cast<long long*>(map.mutableData() + header.dataOffset);
+    size_t length = map.size();
+    void* base = map.detach();
+    return DistMatrix::adopt(rows, (int)header.vertices, header.rowStride,
+                             [base, length](long long*) { MappedFile::release(base, length); });
+}
+
+// Binary matrix files (see matrix_file.h). An int64 file whose no-edge value is
+// UNREACHABLE is used in place: two private copy-on-write mappings become the
+// weight and dist matrices, so loading costs no parsing and no copy. Any other
+// binary file is translated into a DistMatrix first.
+void useBinaryGraph(const string& filename) {
+    MappedFile weightMap;
+    MatrixFileHeader header;
+    string error;
+    if (!openMatrixFile(filename, true, weightMap, header, error)) {
+        cout << "**Error:** " << error << endl;
+        return;
+    }
+    int V = (int)header.vertices;
+
+    bool inPlace = header.dtype == MATRIX_INT64 && header.noEdge == UNREACHABLE &&
+                   header.rowStride * sizeof(long long) % DistMatrix::ALIGNMENT == 0;
+    if (inPlace) {
+        MappedFile distMap;
+        if (!openMatrixFile(filename, true, distMap, header, error)) {
+            cout << "**Error:** " << error << endl;
+            return;
+        }
+        cout << "\nGraph mapped from " << filename << " (" << V << " vertices, zero-copy)" << endl;
+        FloydWarshall fw(adoptMappedMatrix(weightMap, header), adoptMappedMatrix(distMap, header));
+        runFloydWarshall(fw);
+        return;
+    }
+
+    DistMatrix graph(V, INF);
+    size_t rowBytes = header.rowStride * matrixElementSize(header.dtype);
+    for (int i = 0; i < V; i++) {
+        const char* src = weightMap.data() + header.dataOffset + i * rowBytes;
+        long long* row = graph.rowData(i);
+        for (int j = 0; j < V; j++) {
+            long long value = (header.dtype == MATRIX_INT64)
+                                  ? reinterpret_cast<const int64_t*>(src)[j]
+                                  : reinterpret_cast<const int32_t*>(src)[j];
+            row[j] = (value == header.noEdge) ? INF : value;
+        }
+    }
+    weightMap.close();
+
+    cout << "\nGraph loaded successfully from " << filename << endl;
+    FloydWarshall fw(V);
+    fw.setGraph(graph);
+    runFloydWarshall(fw);
+}
+
 // **New method for file input**
 void useFileGraph() {
     string filename;
-    cout << "Enter the filename (e.g., graph.txt): ";
+    cout << "Enter the filename (e.g., graph.txt or a binary .mat from matrix_convert): ";
     cin >> filename;
 
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cout << "**Error:** Could not open file: " << filename << endl;
+    if (isMatrixFile(filename)) {
+        useBinaryGraph(filename);
         return;
     }
 
-    int V;
-    if (!(file >> V) || V <= 0) {
-        cout << "**Error:** Invalid or missing number of vertices in the first line." << endl;
+    TextMatrixReader reader;
+    if (!reader.open(filename)) {
+        cout << "**Error:** " << reader.message("vertices") << endl;
         return;
     }
 
+    int V = reader.vertices();
     FloydWarshall fw(V);
-    vector<vector<long long>> graph(V, vector<long long>(V));
-    string line;
-    
-    // Consume the rest of the first line after reading V
-    getline(file, line); 
+    DistMatrix graph(V, INF);
+    if (!reader.readRows<long long>([&](int i) { return graph.rowData(i); })) {
+        cout << "**Error:** " << reader.message("vertices") << endl;
+        return;
+    }
 
-    for (int i = 0; i < V; i++) {
-        if (!getline(file, line)) {
-            cout << "**Error:** File ended unexpectedly. Expected " << V << " rows for the matrix." << endl;
-            return;
+    cout << "\nGraph loaded successfully from " << filename << endl;
+    fw.setGraph(graph);
+    runFloydWarshall(fw);
+}
+
+// Read a saved result. dist is used straight from the private mapping; next
+// is widened to int, or also used in place when it was stored as 32 bits.
+// Every next entry must be a vertex or the no-hop marker, so a damaged file
+// cannot send path reconstruction outside the matrices.
+bool loadSnapshot(const string& filename, DistMatrix& dist, NextMatrix& next, long long& edgeCount,
+                  string& error) {
+    MappedFile map;
+    if (!map.open(filename, true)) {
+        error = "Could not open file: " + filename;
+        return false;
+    }
+    SnapshotHeader header;
+    if (map.size() < sizeof(header)) {
+        error = "File is too small to hold a snapshot header.";
+        return false;
+    }
+    memcpy(&header, map.data(), sizeof(header));
+    if (memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        error = "Not a shortest-path snapshot (bad magic).";
+        return false;
+    }
+    if (header.version != SNAPSHOT_VERSION) {
+        error = "Unsupported snapshot version " + to_string(header.version) + ".";
+        return false;
+    }
+    uint64_t V = header.vertices;
+    if (V == 0 || V > INT_MAX || (header.nextWidth != 2 && header.nextWidth != 4) ||
+        header.distStride < V || header.nextStride < V ||
+        header.distStride * sizeof(long long) % DistMatrix::ALIGNMENT != 0 ||
+        header.nextStride * header.nextWidth % DistMatrix::ALIGNMENT != 0 ||
+        header.distOffset < sizeof(header) ||
+        header.distOffset % DistMatrix::ALIGNMENT != 0 || header.nextOffset % DistMatrix::ALIGNMENT != 0 ||
+        !regionFits(header.distOffset, V, header.distStride, sizeof(long long), header.nextOffset) ||
+        !regionFits(header.nextOffset, V, header.nextStride, header.nextWidth, map.size())) {
+        error = "Corrupt snapshot header.";
+        return false;
+    }
+
+    char* base = map.mutableData();
+    for (uint64_t i = 0; i < V; i++) {
+        const char* row = base + header.nextOffset + i * header.nextStride * header.nextWidth;
+        for (uint64_t j = 0; j < V; j++) {
+            uint32_t hop;
+            if (header.nextWidth == 4) {
+                memcpy(&hop, row + j * 4, 4);
+            } else {
+                uint16_t narrow;
+                memcpy(&narrow, row + j * 2, 2);
+                hop = (narrow == 0xFFFF) ? 0xFFFFFFFF : narrow;
+            }
+            if (hop != 0xFFFFFFFF && hop >= V) {
+                error = "Corrupt snapshot: next hop " + to_string(hop) + " at (" + to_string(i) + ", " +
+                        to_string(j) + ") is not a vertex.";
+                return false;
+            }
         }
-        stringstream ss(line);
-        for (int j = 0; j < V; j++) {
-            long long weight;
-            if (!(ss >> weight)) {
-                cout << "**Error:** Missing weight at row " << i << ", column " << j << "." << endl;
-                return;
+    }
+
+    size_t length = map.size();
+    shared_ptr<void> mapping(map.detach(), [length](void* p) { MappedFile::release(p, length); });
+
+    dist = DistMatrix::adopt(reinterpret_cast<long long*>(base + header.distOffset), (int)V,
+                             header.distStride, [mapping](long long*) {});
+    if (header.nextWidth == 4) {
+        next = NextMatrix::adopt(reinterpret_cast<int*>(base + header.nextOffset), (int)V,
+                                 header.nextStride, [mapping](int*) {});
+    } else {
+        next = NextMatrix((int)V, -1);
+        for (uint64_t i = 0; i < V; i++) {
+            const uint16_t* src = reinterpret_cast<const uint16_t*>(base + header.nextOffset) + i * header.nextStride;
+            int* dst = next.rowData((int)i);
+            for (uint64_t j = 0; j < V; j++) {
+                dst[j] = (src[j] == 0xFFFF) ? -1 : src[j];
             }
-            graph[i][j] = weight;
         }
     }
+    edgeCount = (long long)header.edgeCount;
+    return true;
+}
 
-    cout << "\nGraph loaded successfully from " << filename << endl;
-    fw.setGraph(graph);
-    runFloydWarshall(fw);
+// Restore a saved result and explore it like a fresh computation.
+void useSnapshot() {
+    string filename;
+    cout << "Enter the snapshot filename (e.g., graph.apsp): ";
+    cin >> filename;
+
+    DistMatrix dist;
+    NextMatrix next;
+    long long edgeCount;
+    string error;
+    if (!loadSnapshot(filename, dist, next, edgeCount, error)) {
+        cout << "**Error:** " << error << endl;
+        return;
+    }
+
+    cout << "\nSnapshot loaded from " << filename << " (" << dist.size() << " vertices, "
+         << edgeCount << " edges)" << endl;
+    FloydWarshall fw(move(dist), move(next), edgeCount);
+    exploreResults(fw);
 }
 
+// Tests include this file with P1_NO_MAIN defined to reach the engines directly.
+#ifndef P1_NO_MAIN
 int main() {
     cout << "=======================================" << endl;
     cout << "  Floyd-Warshall Algorithm" << endl;
@@ -269,7 +1437,8 @@ int main() {
     cout << "1. Use predefined graph (8 vertices)" << endl;
     cout << "2. Input custom graph from console" << endl;
     cout << "**3. Input custom graph from text file**" << endl; // New option
-    cout << "Enter choice (1, 2, or 3): ";
+    cout << "4. Load a saved shortest-path snapshot" << endl;
+    cout << "Enter choice (1, 2, 3, or 4): ";
     
     if (!(cin >> choice)) {
         cout << "Invalid input for choice." << endl;
@@ -286,9 +1455,13 @@ int main() {
         case 3:
             useFileGraph(); // Call the new function
             break;
+        case 4:
+            useSnapshot();
+            break;
         default:
             cout << "Invalid choice!" << endl;
     }
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
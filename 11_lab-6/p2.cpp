@@ -1,51 +1,320 @@
 #include <iostream>
-#include <fstream> // Required for file operations
-#include <sstream> // Required for parsing lines
 #include <vector>
 #include <algorithm>
 #include <climits>
 #include <iomanip>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+#include "matrix_file.h"
 
 using namespace std;
 
 #define INF INT_MAX
 
+enum SolverMode { SOLVER_BRUTE_FORCE, SOLVER_HELD_KARP, SOLVER_ENUMERATE };
+
+// Held-Karp keeps one int cost and one byte parent per (subset, last city)
+// state; runs whose table would exceed this many MB are refused.
+const long long DEFAULT_MEMORY_LIMIT_MB = 2048;
+
 class TSP {
 private:
     int n;
     vector<vector<int>> dist;
     vector<int> bestPath;
     int minCost;
+    SolverMode mode;
+    long long memoryLimitMB;
+
+    // One worker's view of the search. Tasks are handed out in prefix order, so
+    // keeping the first cheapest tour per worker and breaking ties between
+    // workers by task gives the same tour as a single-threaded run.
+    struct Search {
+        vector<int> path;
+        vector<bool> visited;
+        vector<int> bestPath;
+        int bestCost;
+        int task, bestTask;
+    };
 
-    void bruteForce(vector<int>& path, vector<bool>& visited, int count, int cost, int pos) {
+    int threadCount;
+    atomic<int> sharedBest; // cheapest complete tour found so far, by any worker
+    vector<int> minOut;     // cheapest edge leaving each city
+
+    void lowerSharedBest(int cost) {
+        int seen = sharedBest.load(memory_order_relaxed);
+        while (cost < seen && !sharedBest.compare_exchange_weak(seen, cost, memory_order_relaxed)) {
+        }
+    }
+
+    // Depth-first branch and bound. `remaining` is the sum of minOut over the
+    // unvisited cities: every one of them still has to be left once, so
+    // cost + dist[pos][i] + remaining is a lower bound on any tour through i.
+    // Ties are not pruned, which keeps the reported tour the first optimal one.
+    void bruteForce(Search& s, int count, int cost, int pos, long long remaining) {
         // Base case: All cities have been visited
         if (count == n) {
             // Check if a path back to the starting city (0) exists
             if (dist[pos][0] != INF) {
                 int totalCost = cost + dist[pos][0];
-                if (totalCost < minCost) {
-                    minCost = totalCost;
-                    bestPath = path;
-                    bestPath.push_back(0); // Complete the cycle
+                if (totalCost < s.bestCost) {
+                    s.bestCost = totalCost;
+                    s.bestTask = s.task;
+                    s.bestPath = s.path;
+                    s.bestPath.push_back(0); // Complete the cycle
+                    lowerSharedBest(totalCost);
                 }
             }
             return;
         }
 
-        // Recursive step: Try every unvisited city
+        // Recursive step: Try every unvisited city whose bound can still beat the best tour
         for (int i = 1; i < n; i++) {
-            if (!visited[i] && dist[pos][i] != INF) {
-                visited[i] = true;
-                path.push_back(i);
-                bruteForce(path, visited, count + 1, cost + dist[pos][i], i);
-                path.pop_back(); // Backtrack
-                visited[i] = false; // Backtrack
+            if (!s.visited[i] && dist[pos][i] != INF) {
+                if ((long long)cost + dist[pos][i] + remaining > sharedBest.load(memory_order_relaxed)) {
+                    continue;
+                }
+                s.visited[i] = true;
+                s.path.push_back(i);
+                bruteForce(s, count + 1, cost + dist[pos][i], i, remaining - minOut[i]);
+                s.path.pop_back(); // Backtrack
+                s.visited[i] = false; // Backtrack
+            }
+        }
+    }
+
+    // Cost of the greedy nearest-neighbour tour from city 0, or INF if it gets
+    // stuck. It seeds the incumbent so pruning starts from the first node.
+    int nearestNeighbourCost() const {
+        vector<bool> seen(n, false);
+        seen[0] = true;
+        int pos = 0;
+        long long total = 0;
+        for (int step = 1; step < n; step++) {
+            int nearest = -1;
+            for (int c = 1; c < n; c++) {
+                if (!seen[c] && dist[pos][c] != INF && (nearest < 0 || dist[pos][c] < dist[pos][nearest])) {
+                    nearest = c;
+                }
             }
+            if (nearest < 0) return INF;
+            seen[nearest] = true;
+            total += dist[pos][nearest];
+            pos = nearest;
         }
+        if (dist[pos][0] == INF) return INF;
+        total += dist[pos][0];
+        return total < INF ? (int)total : INF;
+    }
+
+    // Split the search tree on its first two levels below city 0 and let the
+    // workers pull prefixes from a shared counter.
+    void solveBruteForce() {
+        vector<vector<int>> prefixes;
+        int depth = min(2, n - 1);
+        vector<int> prefix = {0};
+        function<void()> collect = [&]() {
+            if ((int)prefix.size() == depth + 1) {
+                prefixes.push_back(prefix);
+                return;
+            }
+            for (int i = 1; i < n; i++) {
+                if (find(prefix.begin(), prefix.end(), i) == prefix.end() && dist[prefix.back()][i] != INF) {
+                    prefix.push_back(i);
+                    collect();
+                    prefix.pop_back();
+                }
+            }
+        };
+        collect();
+
+        minOut.assign(n, INF);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (i != j && dist[i][j] != INF) {
+                    minOut[i] = min(minOut[i], dist[i][j]);
+                }
+            }
+            if (n > 1 && minOut[i] == INF) {
+                return; // a city with no way out: no tour exists
+            }
+        }
+        sharedBest.store(nearestNeighbourCost());
+
+        int workers = max(1, min(threadCount, (int)prefixes.size()));
+        vector<Search> searches(workers);
+        atomic<int> nextTask(0);
+        auto work = [&](int w) {
+            Search& s = searches[w];
+            s.bestCost = INF;
+            s.bestTask = INT_MAX;
+            for (int t = nextTask++; t < (int)prefixes.size(); t = nextTask++) {
+                s.task = t;
+                s.path = prefixes[t];
+                s.visited.assign(n, false);
+                int cost = 0;
+                for (size_t k = 0; k < s.path.size(); k++) {
+                    s.visited[s.path[k]] = true;
+                    if (k > 0) cost += dist[s.path[k - 1]][s.path[k]];
+                }
+                long long remaining = 0;
+                for (int c = 1; c < n; c++) {
+                    if (!s.visited[c]) remaining += minOut[c];
+                }
+                bruteForce(s, s.path.size(), cost, s.path.back(), remaining);
+            }
+        };
+        vector<thread> pool;
+        for (int w = 1; w < workers; w++) {
+            pool.emplace_back(work, w);
+        }
+        work(0);
+        for (thread& t : pool) {
+            t.join();
+        }
+
+        const Search* best = nullptr;
+        for (const Search& s : searches) {
+            if (s.bestCost == INF) continue;
+            if (best == nullptr || s.bestCost < best->bestCost ||
+                (s.bestCost == best->bestCost && s.bestTask < best->bestTask)) {
+                best = &s;
+            }
+        }
+        if (best != nullptr) {
+            minCost = best->bestCost;
+            bestPath = best->bestPath;
+        }
+    }
+
+    bool isSymmetric() const {
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < i; j++) {
+                if (dist[i][j] != dist[j][i]) return false;
+            }
+        }
+        return true;
+    }
+
+    // Every tour from city 0 in lexicographic order, without recursion. The
+    // arrays are sized once: path[d] is the city at depth d, choice[d] the next
+    // candidate to try there and cost[d] the length of path[0..d]. On a
+    // symmetric matrix a cycle and its reverse cost the same, so only the
+    // orientation that visits city 1 before city 2 is walked.
+    void enumerateTours() {
+        vector<int> path(n), choice(n + 1, 1), bestTour(n);
+        vector<long long> cost(n, 0);
+        vector<char> used(n, 0);
+        bool halve = n >= 3 && isSymmetric();
+        long long best = INF;
+
+        path[0] = 0;
+        used[0] = 1;
+        int depth = 1;
+        while (depth > 0) {
+            if (depth == n) {
+                int last = path[n - 1];
+                if (dist[last][0] != INF && cost[n - 1] + dist[last][0] < best) {
+                    best = cost[n - 1] + dist[last][0];
+                    copy(path.begin(), path.end(), bestTour.begin());
+                }
+                depth--;
+                used[path[depth]] = 0;
+                continue;
+            }
+
+            int from = path[depth - 1];
+            int c = choice[depth];
+            while (c < n && (used[c] || dist[from][c] == INF || (halve && c == 2 && !used[1]))) {
+                c++;
+            }
+            if (c == n) { // level exhausted: backtrack
+                depth--;
+                if (depth > 0) used[path[depth]] = 0;
+                continue;
+            }
+
+            choice[depth] = c + 1;
+            used[c] = 1;
+            path[depth] = c;
+            cost[depth] = cost[depth - 1] + dist[from][c];
+            depth++;
+            choice[depth] = 1;
+        }
+
+        if (best < INF) {
+            minCost = (int)best;
+            bestPath.assign(bestTour.begin(), bestTour.end());
+            bestPath.push_back(0); // Complete the cycle
+        }
+    }
+
+    // Held-Karp over subsets of cities 1..n-1 (bit c-1 is city c). cost[mask][last]
+    // is the cheapest path 0 -> ... -> last visiting exactly `mask`, stored flat
+    // at mask * (n-1) + (last-1) with `parent` holding the city before `last`.
+    void heldKarp() {
+        int m = n - 1;
+        size_t states = ((size_t)1 << m) * m;
+        vector<int> cost(states, INF);
+        vector<uint8_t> parent(states, 0);
+
+        for (int c = 1; c < n; c++) {
+            if (dist[0][c] != INF) {
+                cost[((size_t)1 << (c - 1)) * m + (c - 1)] = dist[0][c];
+            }
+        }
+
+        size_t full = ((size_t)1 << m) - 1;
+        for (size_t mask = 1; mask <= full; mask++) {
+            const int* row = &cost[mask * m];
+            for (int last = 1; last < n; last++) {
+                int base = row[last - 1];
+                if (base == INF) continue;
+                const vector<int>& out = dist[last];
+                for (int c = 1; c < n; c++) {
+                    size_t bit = (size_t)1 << (c - 1);
+                    if ((mask & bit) || out[c] == INF) continue;
+                    long long total = (long long)base + out[c];
+                    size_t state = (mask | bit) * m + (c - 1);
+                    if (total < cost[state]) {
+                        cost[state] = (int)total;
+                        parent[state] = (uint8_t)last;
+                    }
+                }
+            }
+        }
+
+        int bestLast = -1;
+        for (int last = 1; last < n; last++) {
+            int base = cost[full * m + (last - 1)];
+            if (base == INF || dist[last][0] == INF) continue;
+            long long total = (long long)base + dist[last][0];
+            if (total < minCost) {
+                minCost = (int)total;
+                bestLast = last;
+            }
+        }
+        if (bestLast < 0) return;
+
+        // Walk the parents back from the full subset, then reverse.
+        bestPath.assign(1, 0);
+        size_t mask = full;
+        for (int city = bestLast; city != 0;) {
+            bestPath.push_back(city);
+            int prev = parent[mask * m + (city - 1)];
+            mask &= ~((size_t)1 << (city - 1));
+            city = prev;
+        }
+        bestPath.push_back(0);
+        reverse(bestPath.begin(), bestPath.end());
     }
 
 public:
-    TSP(int cities) : n(cities), minCost(INF) {
+    TSP(int cities) : n(cities), minCost(INF), mode(SOLVER_BRUTE_FORCE), memoryLimitMB(DEFAULT_MEMORY_LIMIT_MB),
+          threadCount(1), sharedBest(INF) {
         dist.resize(n, vector<int>(n));
         bestPath.clear();
     }
@@ -64,14 +333,52 @@ public:
         dist = graph;
     }
 
-    void solve() {
-        vector<int> path = {0};
-        vector<bool> visited(n, false);
-        visited[0] = true;
-        
+    void setMode(SolverMode m) {
+        mode = m;
+    }
+
+    void setMemoryLimit(long long megabytes) {
+        memoryLimitMB = megabytes;
+    }
+
+    // Number of worker threads for the brute-force search (1 = run serially).
+    void setThreadCount(int count) {
+        threadCount = max(1, count);
+    }
+
+    // Bytes the Held-Karp tables need for this instance.
+    long long heldKarpMemory() const {
+        if (n < 2) return 0;
+        if (n - 1 > 40) return LLONG_MAX; // far past any memory limit
+        long long states = (1LL << (n - 1)) * (n - 1);
+        return states * (long long)(sizeof(int) + sizeof(uint8_t));
+    }
+
+    // Returns false when the chosen mode refuses to run on this instance.
+    bool solve() {
+        if (mode == SOLVER_HELD_KARP && n > 1) {
+            long long bytes = heldKarpMemory();
+            long long limit = memoryLimitMB << 20;
+            if (bytes > limit) {
+                cout << "\nHeld-Karp needs about " << (bytes >> 20)
+                     << " MB for " << n << " cities, over the " << memoryLimitMB << " MB limit.\n";
+                return false;
+            }
+            cout << "\nSolving TSP using Held-Karp dynamic programming (" << (bytes >> 20) << " MB)...\n";
+            heldKarp();
+            return true;
+        }
+
+        if (mode == SOLVER_ENUMERATE) {
+            cout << "\nSolving TSP by enumerating every tour...\n";
+            enumerateTours();
+            return true;
+        }
+
         cout << "\nSolving TSP using Brute Force...\n";
         // The brute force approach calculates (n-1)! permutations
-        bruteForce(path, visited, 1, 0, 0);
+        solveBruteForce();
+        return true;
     }
 
     void displayResult() {
@@ -120,9 +427,33 @@ public:
 };
 
 void runTSP(TSP& tsp) {
+    int solver;
+    cout << "\nSolver (1 = brute force, 2 = Held-Karp dynamic programming, 3 = plain enumeration): ";
+    if (!(cin >> solver)) {
+        solver = 1;
+    }
+    if (solver == 3) {
+        tsp.setMode(SOLVER_ENUMERATE);
+    } else if (solver == 2) {
+        tsp.setMode(SOLVER_HELD_KARP);
+        long long limit;
+        cout << "Memory limit in MB (0 = default " << DEFAULT_MEMORY_LIMIT_MB << "): ";
+        if (cin >> limit && limit > 0) {
+            tsp.setMemoryLimit(limit);
+        }
+    } else {
+        int threads;
+        cout << "Worker threads (1 = single-threaded, this machine has "
+             << thread::hardware_concurrency() << "): ";
+        if (cin >> threads && threads > 1) {
+            tsp.setThreadCount(threads);
+        }
+    }
+
     tsp.displayGraph();
-    tsp.solve();
-    tsp.displayResult();
+    if (tsp.solve()) {
+        tsp.displayResult();
+    }
 }
 
 void testCase1() {
@@ -192,48 +523,42 @@ void customInput() {
     runTSP(tsp);
 }
 
-// 🆕 New function for file input
-void useFileGraph() {
-    string filename;
-    cout << "Enter the filename (e.g., graph.txt): ";
-    cin >> filename;
-
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cout << "**Error:** Could not open file: " << filename << endl;
-        return;
+// Read the text matrix format: V on the first line, then V rows of V weights.
+bool loadTextGraph(const string& filename, vector<vector<int>>& graph) {
+    TextMatrixReader reader;
+    if (!reader.open(filename)) {
+        cout << "**Error:** " << reader.message("vertices") << endl;
+        return false;
     }
 
-    int V;
-    if (!(file >> V) || V <= 0) {
-        cout << "**Error:** Invalid or missing number of vertices in the first line." << endl;
-        return;
+    int n = reader.vertices();
+    graph.assign(n, vector<int>(n));
+    if (!reader.readRows<int>([&](int i) { return graph[i].data(); })) {
+        cout << "**Error:** " << reader.message("vertices") << endl;
+        return false;
     }
+    return true;
+}
 
-    TSP tsp(V);
-    vector<vector<int>> graph(V, vector<int>(V));
-    string line;
-    
-    // Consume the rest of the first line after reading V
-    getline(file, line); 
+// 🆕 New function for file input (text matrix or binary file from matrix_convert)
+void useFileGraph() {
+    string filename;
+    cout << "Enter the filename (e.g., graph.txt): ";
+    cin >> filename;
 
-    for (int i = 0; i < V; i++) {
-        if (!getline(file, line)) {
-            cout << "**Error:** File ended unexpectedly. Expected " << V << " rows for the matrix." << endl;
+    vector<vector<int>> graph;
+    if (isMatrixFile(filename)) {
+        string error;
+        if (!loadMatrixFileRows(filename, graph, (int)INF, error)) {
+            cout << "**Error:** " << error << endl;
             return;
         }
-        stringstream ss(line);
-        for (int j = 0; j < V; j++) {
-            int weight;
-            if (!(ss >> weight)) {
-                cout << "**Error:** Missing weight at row " << i << ", column " << j << "." << endl;
-                return;
-            }
-            graph[i][j] = weight;
-        }
+    } else if (!loadTextGraph(filename, graph)) {
+        return;
     }
 
     cout << "\nGraph loaded successfully from " << filename << endl;
+    TSP tsp(graph.size());
     tsp.setGraph(graph);
     runTSP(tsp);
 }
@@ -1,16 +1,42 @@
 #include <iostream>
-#include <fstream>   // Required for file operations
-#include <sstream>   // Required for parsing lines
 #include <vector>
 #include <algorithm>
 #include <climits>
 #include <iomanip>
+#include <deque>
+#include <cmath>
+#include <cctype>
+
+#include "matrix_file.h"
 
 using namespace std;
 
 // Using INT_MAX for infinity, consistent with the original code
 #define INF INT_MAX
 
+enum MSTMethod { MST_AUTO, MST_KRUSKAL, MST_PRIM };
+
+enum TourMethod { TOUR_MST_PREORDER, TOUR_CHRISTOFIDES };
+
+// Christofides matches the odd-degree MST vertices exactly (blossom, O(k^3)
+// time, O(k^2) memory) up to this many of them, and greedily above it.
+const int DEFAULT_EXACT_MATCHING_LIMIT = 800;
+
+// MST_AUTO uses Prim when at least this fraction of the city pairs have a finite
+// distance: Kruskal's sorted edge list costs O(E log E) time and 12 bytes per
+// edge, Prim's arrays O(V^2) time and O(V) memory.
+const double PRIM_DENSITY = 0.25;
+
+// Candidate moves in the local search only connect a city to one of its
+// NEIGHBOUR_COUNT nearest cities, and Or-opt moves segments of up to
+// OR_OPT_MAX_SEGMENT cities.
+const int NEIGHBOUR_COUNT = 10;
+const int OR_OPT_MAX_SEGMENT = 3;
+
+// For coordinate input each city keeps its CANDIDATE_NEIGHBOURS nearest cities;
+// they answer most of Boruvka's closest-other-component queries on their own.
+const int CANDIDATE_NEIGHBOURS = 8;
+
 struct Edge
 {
     int src, dest, weight;
@@ -39,28 +65,1004 @@ public:
         return parent[x];
     }
 
-    bool unite(int x, int y)
+    bool unite(int x, int y)
+    {
+        int px = find(x), py = find(y);
+        if (px == py)
+            return false;
+        if (rank[px] < rank[py])
+            swap(px, py);
+        parent[py] = px;
+        if (rank[px] == rank[py])
+            rank[px]++;
+        return true;
+    }
+};
+
+// Maximum-weight matching on a general graph (Edmonds' blossom algorithm with
+// dual variables, O(n^3)). Vertices are 1..n, and only edges with positive
+// weight exist. Blossoms get ids n+1..2n; st[x] is the outermost blossom that
+// contains x, and S[x] is 0 for even (outer) labels, 1 for odd, -1 for free.
+class WeightedMatching
+{
+    struct MEdge
+    {
+        int u, v;
+        long long w;
+    };
+
+    int n, nx;
+    vector<vector<MEdge>> g;
+    vector<long long> lab;
+    vector<int> match, slack, st, pa, S, vis;
+    vector<vector<int>> flowerFrom, flower;
+    deque<int> q;
+    int stamp;
+
+    long long slackOf(const MEdge &e) const { return lab[e.u] + lab[e.v] - e.w * 2; }
+
+    void updateSlack(int u, int x)
+    {
+        if (!slack[x] || slackOf(g[u][x]) < slackOf(g[slack[x]][x]))
+            slack[x] = u;
+    }
+
+    void setSlack(int x)
+    {
+        slack[x] = 0;
+        for (int u = 1; u <= n; u++)
+        {
+            if (g[u][x].w > 0 && st[u] != x && S[st[u]] == 0)
+                updateSlack(u, x);
+        }
+    }
+
+    void push(int x)
+    {
+        if (x <= n)
+            q.push_back(x);
+        else
+            for (int y : flower[x])
+                push(y);
+    }
+
+    void setSt(int x, int b)
+    {
+        st[x] = b;
+        if (x > n)
+            for (int y : flower[x])
+                setSt(y, b);
+    }
+
+    int evenPosition(int b, int xr)
+    {
+        int pr = find(flower[b].begin(), flower[b].end(), xr) - flower[b].begin();
+        if (pr % 2 == 1)
+        {
+            reverse(flower[b].begin() + 1, flower[b].end());
+            return (int)flower[b].size() - pr;
+        }
+        return pr;
+    }
+
+    void setMatch(int u, int v)
+    {
+        match[u] = g[u][v].v;
+        if (u <= n)
+            return;
+        MEdge e = g[u][v];
+        int xr = flowerFrom[u][e.u], pr = evenPosition(u, xr);
+        for (int i = 0; i < pr; i++)
+            setMatch(flower[u][i], flower[u][i ^ 1]);
+        setMatch(xr, v);
+        rotate(flower[u].begin(), flower[u].begin() + pr, flower[u].end());
+    }
+
+    void augment(int u, int v)
+    {
+        while (true)
+        {
+            int xnv = st[match[u]];
+            setMatch(u, v);
+            if (!xnv)
+                return;
+            setMatch(xnv, st[pa[xnv]]);
+            u = st[pa[xnv]];
+            v = xnv;
+        }
+    }
+
+    int lowestCommonAncestor(int u, int v)
+    {
+        for (++stamp; u || v; swap(u, v))
+        {
+            if (u == 0)
+                continue;
+            if (vis[u] == stamp)
+                return u;
+            vis[u] = stamp;
+            u = st[match[u]];
+            if (u)
+                u = st[pa[u]];
+        }
+        return 0;
+    }
+
+    void addBlossom(int u, int lca, int v)
+    {
+        int b = n + 1;
+        while (b <= nx && st[b])
+            b++;
+        if (b > nx)
+            nx++;
+        lab[b] = 0;
+        S[b] = 0;
+        match[b] = match[lca];
+        flower[b].clear();
+        flower[b].push_back(lca);
+        for (int x = u, y; x != lca; x = st[pa[y]])
+        {
+            flower[b].push_back(x);
+            flower[b].push_back(y = st[match[x]]);
+            push(y);
+        }
+        reverse(flower[b].begin() + 1, flower[b].end());
+        for (int x = v, y; x != lca; x = st[pa[y]])
+        {
+            flower[b].push_back(x);
+            flower[b].push_back(y = st[match[x]]);
+            push(y);
+        }
+        setSt(b, b);
+        for (int x = 1; x <= nx; x++)
+            g[b][x].w = g[x][b].w = 0;
+        for (int x = 1; x <= n; x++)
+            flowerFrom[b][x] = 0;
+        for (int xs : flower[b])
+        {
+            for (int x = 1; x <= nx; x++)
+            {
+                if (g[b][x].w == 0 || slackOf(g[xs][x]) < slackOf(g[b][x]))
+                {
+                    g[b][x] = g[xs][x];
+                    g[x][b] = g[x][xs];
+                }
+            }
+            for (int x = 1; x <= n; x++)
+            {
+                if (flowerFrom[xs][x])
+                    flowerFrom[b][x] = xs;
+            }
+        }
+        setSlack(b);
+    }
+
+    void expandBlossom(int b)
+    {
+        for (int x : flower[b])
+            setSt(x, x);
+        int xr = flowerFrom[b][g[b][pa[b]].u], pr = evenPosition(b, xr);
+        for (int i = 0; i < pr; i += 2)
+        {
+            int xs = flower[b][i], xns = flower[b][i + 1];
+            pa[xs] = g[xns][xs].u;
+            S[xs] = 1;
+            S[xns] = 0;
+            slack[xs] = 0;
+            setSlack(xns);
+            push(xns);
+        }
+        S[xr] = 1;
+        pa[xr] = pa[b];
+        for (size_t i = pr + 1; i < flower[b].size(); i++)
+        {
+            int xs = flower[b][i];
+            S[xs] = -1;
+            setSlack(xs);
+        }
+        st[b] = 0;
+    }
+
+    bool onFoundEdge(const MEdge &e)
+    {
+        int u = st[e.u], v = st[e.v];
+        if (S[v] == -1)
+        {
+            pa[v] = e.u;
+            S[v] = 1;
+            int nu = st[match[v]];
+            slack[v] = slack[nu] = 0;
+            S[nu] = 0;
+            push(nu);
+        }
+        else if (S[v] == 0)
+        {
+            int lca = lowestCommonAncestor(u, v);
+            if (!lca)
+            {
+                augment(u, v);
+                augment(v, u);
+                return true;
+            }
+            addBlossom(u, lca, v);
+        }
+        return false;
+    }
+
+    // One augmentation: grow alternating trees, adjusting duals, until an
+    // augmenting path is found (true) or no further improvement exists.
+    bool augmentOnce()
+    {
+        fill(S.begin() + 1, S.begin() + nx + 1, -1);
+        fill(slack.begin() + 1, slack.begin() + nx + 1, 0);
+        q.clear();
+        for (int x = 1; x <= nx; x++)
+        {
+            if (st[x] == x && !match[x])
+            {
+                pa[x] = 0;
+                S[x] = 0;
+                push(x);
+            }
+        }
+        if (q.empty())
+            return false;
+
+        while (true)
+        {
+            while (!q.empty())
+            {
+                int u = q.front();
+                q.pop_front();
+                if (S[st[u]] == 1)
+                    continue;
+                for (int v = 1; v <= n; v++)
+                {
+                    if (g[u][v].w > 0 && st[u] != st[v])
+                    {
+                        if (slackOf(g[u][v]) == 0)
+                        {
+                            if (onFoundEdge(g[u][v]))
+                                return true;
+                        }
+                        else
+                        {
+                            updateSlack(u, st[v]);
+                        }
+                    }
+                }
+            }
+
+            long long d = LLONG_MAX;
+            for (int b = n + 1; b <= nx; b++)
+            {
+                if (st[b] == b && S[b] == 1)
+                    d = min(d, lab[b] / 2);
+            }
+            for (int x = 1; x <= nx; x++)
+            {
+                if (st[x] == x && slack[x])
+                {
+                    if (S[x] == -1)
+                        d = min(d, slackOf(g[slack[x]][x]));
+                    else if (S[x] == 0)
+                        d = min(d, slackOf(g[slack[x]][x]) / 2);
+                }
+            }
+            for (int u = 1; u <= n; u++)
+            {
+                if (S[st[u]] == 0)
+                {
+                    if (lab[u] <= d)
+                        return false;
+                    lab[u] -= d;
+                }
+                else if (S[st[u]] == 1)
+                {
+                    lab[u] += d;
+                }
+            }
+            for (int b = n + 1; b <= nx; b++)
+            {
+                if (st[b] == b)
+                {
+                    if (S[st[b]] == 0)
+                        lab[b] += d * 2;
+                    else if (S[st[b]] == 1)
+                        lab[b] -= d * 2;
+                }
+            }
+
+            q.clear();
+            for (int x = 1; x <= nx; x++)
+            {
+                if (st[x] == x && slack[x] && st[slack[x]] != x && slackOf(g[slack[x]][x]) == 0)
+                {
+                    if (onFoundEdge(g[slack[x]][x]))
+                        return true;
+                }
+            }
+            for (int b = n + 1; b <= nx; b++)
+            {
+                if (st[b] == b && S[b] == 1 && lab[b] == 0)
+                    expandBlossom(b);
+            }
+        }
+    }
+
+public:
+    explicit WeightedMatching(int vertices)
+        : n(vertices), nx(vertices), g(2 * vertices + 1, vector<MEdge>(2 * vertices + 1)),
+          lab(2 * vertices + 1, 0), match(2 * vertices + 1, 0), slack(2 * vertices + 1, 0),
+          st(2 * vertices + 1, 0), pa(2 * vertices + 1, 0), S(2 * vertices + 1, -1), vis(2 * vertices + 1, 0),
+          flowerFrom(2 * vertices + 1, vector<int>(vertices + 1, 0)), flower(2 * vertices + 1), stamp(0)
+    {
+        for (int u = 1; u <= n; u++)
+            for (int v = 1; v <= n; v++)
+                g[u][v] = {u, v, 0};
+    }
+
+    void addEdge(int u, int v, long long w)
+    {
+        g[u][v].w = g[v][u].w = w;
+    }
+
+    void solve()
+    {
+        for (int u = 0; u <= n; u++)
+        {
+            st[u] = u;
+            flower[u].clear();
+        }
+        long long wMax = 0;
+        for (int u = 1; u <= n; u++)
+        {
+            for (int v = 1; v <= n; v++)
+            {
+                flowerFrom[u][v] = (u == v) ? u : 0;
+                wMax = max(wMax, g[u][v].w);
+            }
+        }
+        for (int u = 1; u <= n; u++)
+            lab[u] = wMax;
+        while (augmentOnce())
+        {
+        }
+    }
+
+    // Partner of u in the matching, or 0
+    int mate(int u) const { return match[u]; }
+};
+
+// A pair of cities ordered by squared distance, then by ids, so that equal
+// distances still compare strictly.
+struct PointPair
+{
+    double d2;
+    int a, b; // a < b, or -1 for none yet
+
+    bool operator<(const PointPair &other) const
+    {
+        if (d2 != other.d2)
+            return d2 < other.d2;
+        return a != other.a ? a < other.a : b < other.b;
+    }
+};
+
+// Uniform grid over a subset of points for k-nearest-neighbour queries. Cells
+// hold about two points each, and a query scans rings of cells around its own
+// until the next ring cannot contain anything closer than the k-th best.
+class PointGrid
+{
+    const vector<double> &xs, &ys;
+    double minX, minY, cell;
+    int cols, rows;
+    vector<int> cellStart, cellItems;
+
+    // Component labels for nearestForeign: level L has one cell per 2^L x 2^L
+    // grid cells, labelled with the component of every city in it, or
+    // MIXED_CELL / EMPTY_CELL. The last level is a single cell.
+    static constexpr int MIXED_CELL = -1;
+    static constexpr int EMPTY_CELL = -2;
+    vector<int> levelCols, levelRows;
+    vector<vector<int>> labels;
+
+    static int mergeLabels(int a, int b)
+    {
+        if (a == EMPTY_CELL)
+            return b;
+        if (b == EMPTY_CELL || a == b)
+            return a;
+        return MIXED_CELL;
+    }
+
+    double boxDistanceSq(int level, int cx, int cy, int p) const
+    {
+        double span = cell * (double)(1 << level);
+        double x0 = minX + cx * span, y0 = minY + cy * span;
+        double dx = max(0.0, max(x0 - xs[p], xs[p] - (x0 + span)));
+        double dy = max(0.0, max(y0 - ys[p], ys[p] - (y0 + span)));
+        return dx * dx + dy * dy;
+    }
+
+    void visitForeign(int level, int cx, int cy, int p, const vector<int> &comp, PointPair &best) const
+    {
+        int label = labels[level][(size_t)cy * levelCols[level] + cx];
+        if (label == EMPTY_CELL || label == comp[p] || boxDistanceSq(level, cx, cy, p) > best.d2)
+            return;
+
+        if (level == 0)
+        {
+            size_t c = (size_t)cy * cols + cx;
+            for (int i = cellStart[c]; i < cellStart[c + 1]; i++)
+            {
+                int q = cellItems[i];
+                if (comp[q] == comp[p])
+                    continue;
+                double dx = xs[q] - xs[p], dy = ys[q] - ys[p];
+                PointPair candidate = {dx * dx + dy * dy, min(p, q), max(p, q)};
+                if (candidate < best)
+                    best = candidate;
+            }
+            return;
+        }
+
+        // Nearer children first, so the bound shrinks before the others are tried
+        pair<double, int> children[4];
+        int count = 0;
+        for (int j = 0; j < 4; j++)
+        {
+            int x = 2 * cx + (j & 1), y = 2 * cy + (j >> 1);
+            if (x >= levelCols[level - 1] || y >= levelRows[level - 1])
+                continue;
+            pair<double, int> child = make_pair(boxDistanceSq(level - 1, x, y, p), j);
+            int at = count++;
+            for (; at > 0 && child < children[at - 1]; at--)
+                children[at] = children[at - 1];
+            children[at] = child;
+        }
+        for (int c = 0; c < count; c++)
+        {
+            int j = children[c].second;
+            visitForeign(level - 1, 2 * cx + (j & 1), 2 * cy + (j >> 1), p, comp, best);
+        }
+    }
+
+    int column(double x) const { return min(cols - 1, (int)((x - minX) / cell)); }
+    int row(double y) const { return min(rows - 1, (int)((y - minY) / cell)); }
+
+    // Offer every point of cell c except p to the max-heap of the k closest
+    void scanCell(int p, size_t c, int k, vector<pair<double, int>> &best) const
+    {
+        for (int i = cellStart[c]; i < cellStart[c + 1]; i++)
+        {
+            int q = cellItems[i];
+            if (q == p)
+                continue;
+            double dx = xs[q] - xs[p], dy = ys[q] - ys[p];
+            pair<double, int> candidate(dx * dx + dy * dy, q);
+            if ((int)best.size() < k)
+            {
+                best.push_back(candidate);
+                push_heap(best.begin(), best.end());
+            }
+            else if (candidate < best.front())
+            {
+                pop_heap(best.begin(), best.end());
+                best.back() = candidate;
+                push_heap(best.begin(), best.end());
+            }
+        }
+    }
+
+public:
+    PointGrid(const vector<double> &x, const vector<double> &y, const vector<int> &ids)
+        : xs(x), ys(y), minX(0), minY(0), cell(1), cols(1), rows(1)
+    {
+        double maxX = 0, maxY = 0;
+        for (size_t i = 0; i < ids.size(); i++)
+        {
+            double px = xs[ids[i]], py = ys[ids[i]];
+            minX = (i == 0) ? px : min(minX, px);
+            maxX = (i == 0) ? px : max(maxX, px);
+            minY = (i == 0) ? py : min(minY, py);
+            maxY = (i == 0) ? py : max(maxY, py);
+        }
+        // About two points per cell. When the points (nearly) share a line the
+        // area says nothing, and the longer side is split into that many cells
+        double width = max(maxX - minX, 1e-9), height = max(maxY - minY, 1e-9);
+        double cells = (double)max<size_t>(1, ids.size() / 2);
+        cell = max({sqrt(width * height / cells), max(width, height) / cells, 1e-9});
+        cols = (int)min(width / cell + 1, 65536.0);
+        rows = (int)min(height / cell + 1, 65536.0);
+        cell = max(width / cols, height / rows) * (1 + 1e-12);
+
+        cellStart.assign((size_t)cols * rows + 1, 0);
+        for (int id : ids)
+            cellStart[(size_t)row(ys[id]) * cols + column(xs[id]) + 1]++;
+        for (size_t c = 0; c + 1 < cellStart.size(); c++)
+            cellStart[c + 1] += cellStart[c];
+        cellItems.resize(ids.size());
+        vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+        for (int id : ids)
+            cellItems[fill[(size_t)row(ys[id]) * cols + column(xs[id])]++] = id;
+    }
+
+    // The k grid points nearest to point p (p itself excluded), closest first;
+    // fewer when the grid holds fewer points.
+    void nearest(int p, int k, vector<int> &out) const
+    {
+        vector<pair<double, int>> best; // max-heap of the k closest so far
+        int cx = column(xs[p]), cy = row(ys[p]);
+        for (int r = 0;; r++)
+        {
+            if (r > 0 && (int)best.size() == k)
+            {
+                double reach = (r - 1) * cell; // anything in ring r is at least this far
+                if (reach * reach > best.front().first)
+                    break;
+            }
+            if (r > cols && r > rows)
+                break;
+            // Only the part of ring r inside the grid is visited
+            int x0 = max(0, cx - r), x1 = min(cols - 1, cx + r);
+            for (int gy = max(0, cy - r); gy <= min(rows - 1, cy + r); gy++)
+            {
+                if (gy == cy - r || gy == cy + r)
+                {
+                    for (int gx = x0; gx <= x1; gx++)
+                        scanCell(p, (size_t)gy * cols + gx, k, best);
+                }
+                else
+                {
+                    if (cx - r >= 0)
+                        scanCell(p, (size_t)gy * cols + cx - r, k, best);
+                    if (cx + r < cols)
+                        scanCell(p, (size_t)gy * cols + cx + r, k, best);
+                }
+            }
+        }
+        sort_heap(best.begin(), best.end());
+        out.clear();
+        for (const pair<double, int> &b : best)
+            out.push_back(b.second);
+    }
+
+    // Recompute the component labels of every level; comp[i] is city i's component.
+    void labelComponents(const vector<int> &comp)
+    {
+        if (labels.empty())
+        {
+            levelCols.push_back(cols);
+            levelRows.push_back(rows);
+            while (levelCols.back() > 1 || levelRows.back() > 1)
+            {
+                levelCols.push_back((levelCols.back() + 1) / 2);
+                levelRows.push_back((levelRows.back() + 1) / 2);
+            }
+            labels.resize(levelCols.size());
+            for (size_t L = 0; L < labels.size(); L++)
+                labels[L].resize((size_t)levelCols[L] * levelRows[L]);
+        }
+
+        for (size_t c = 0; c + 1 < cellStart.size(); c++)
+        {
+            int label = EMPTY_CELL;
+            for (int i = cellStart[c]; i < cellStart[c + 1]; i++)
+                label = mergeLabels(label, comp[cellItems[i]]);
+            labels[0][c] = label;
+        }
+        for (size_t L = 1; L < labels.size(); L++)
+        {
+            fill(labels[L].begin(), labels[L].end(), EMPTY_CELL);
+            for (int y = 0; y < levelRows[L - 1]; y++)
+                for (int x = 0; x < levelCols[L - 1]; x++)
+                {
+                    int &parent = labels[L][(size_t)(y / 2) * levelCols[L] + x / 2];
+                    parent = mergeLabels(parent, labels[L - 1][(size_t)y * levelCols[L - 1] + x]);
+                }
+        }
+    }
+
+    // Lower `best` to the closest pair between p and a city of another
+    // component, if one beats it. Needs labelComponents for the same comp.
+    void nearestForeign(int p, const vector<int> &comp, PointPair &best) const
+    {
+        int top = labels.size() - 1;
+        visitForeign(top, 0, 0, p, comp, best);
+    }
+};
+
+// A cyclic tour stored as an array plus each city's position in it. Every
+// change is a 2-opt move, done by reversing whichever side of the cycle is
+// shorter, so the stored direction may flip; callers only rely on adjacency.
+class TourArray
+{
+    vector<int> order, pos;
+
+    // Reverse the cities at positions i, i+1, ..., j (cyclically), `len` of them
+    void reverseRange(int i, int j, int len)
+    {
+        int n = order.size();
+        for (int k = 0; k < len / 2; k++)
+        {
+            int a = order[i], b = order[j];
+            order[i] = b;
+            pos[b] = i;
+            order[j] = a;
+            pos[a] = j;
+            i = (i + 1 == n) ? 0 : i + 1;
+            j = (j == 0) ? n - 1 : j - 1;
+        }
+    }
+
+public:
+    explicit TourArray(const vector<int> &cities) : order(cities), pos(cities.size())
+    {
+        for (size_t i = 0; i < order.size(); i++)
+            pos[order[i]] = i;
+    }
+
+    int size() const { return order.size(); }
+    int next(int c) const { return order[pos[c] + 1 == (int)order.size() ? 0 : pos[c] + 1]; }
+    int prev(int c) const { return order[pos[c] == 0 ? order.size() - 1 : pos[c] - 1]; }
+
+    // Reverse the path that runs forward from `from` to `to`
+    void reversePath(int from, int to)
+    {
+        int n = order.size();
+        int i = pos[from], j = pos[to];
+        int len = (j - i + n) % n + 1;
+        if (2 * len > n) // the rest of the cycle is shorter and gives the same tour
+            reverseRange((j + 1) % n, (i - 1 + n) % n, n - len);
+        else
+            reverseRange(i, j, len);
+    }
+
+    // Replace edges (a,b) and (c,d) with (a,c) and (b,d), where b follows a and
+    // d follows c when walking the tour in one direction. d is implied by c.
+    void move(int a, int b, int c)
+    {
+        if (next(a) == b)
+            reversePath(b, c);
+        else
+            reversePath(c, b);
+    }
+
+    // The cycle starting at `start`, closed by repeating it
+    vector<int> cycleFrom(int start) const
+    {
+        vector<int> cycle;
+        cycle.reserve(order.size() + 1);
+        for (size_t k = 0, i = pos[start]; k < order.size(); k++, i = (i + 1 == order.size()) ? 0 : i + 1)
+            cycle.push_back(order[i]);
+        cycle.push_back(start);
+        return cycle;
+    }
+};
+
+class TSP_MST
+{
+private:
+    int n;
+    vector<vector<int>> dist;
+    bool hasCoordinates;    // cities are points; distances are computed, not stored
+    vector<double> xs, ys;
+    vector<Edge> mstEdges;
+    vector<int> tour;
+    long long tourCost;
+    MSTMethod mstMethod;
+    TourMethod tourMethod;
+    int exactMatchingLimit;
+    bool improve;           // run 2-opt and Or-opt after building the tour
+    vector<int> neighbours; // neighbourCount nearest cities of each city, closest first
+    int neighbourCount;
+
+    // TSPLIB EUC_2D: Euclidean distance rounded to the nearest integer
+    long long distance(int a, int b) const
+    {
+        if (hasCoordinates)
+        {
+            double dx = xs[a] - xs[b], dy = ys[a] - ys[b];
+            return (long long)(sqrt(dx * dx + dy * dy) + 0.5);
+        }
+        return dist[a][b];
+    }
+
+    bool isSymmetric() const
+    {
+        if (hasCoordinates)
+            return true;
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = 0; j < i; j++)
+            {
+                if (dist[i][j] != dist[j][i])
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    void buildNeighbours()
+    {
+        neighbourCount = min(NEIGHBOUR_COUNT, n - 1);
+        neighbours.assign((size_t)n * neighbourCount, 0);
+        vector<int> candidates;
+        if (hasCoordinates)
+        {
+            vector<int> all(n);
+            for (int i = 0; i < n; i++)
+                all[i] = i;
+            PointGrid grid(xs, ys, all);
+            for (int i = 0; i < n; i++)
+            {
+                grid.nearest(i, neighbourCount, candidates);
+                copy(candidates.begin(), candidates.end(), neighbours.begin() + (size_t)i * neighbourCount);
+            }
+            return;
+        }
+        for (int i = 0; i < n; i++)
+        {
+            candidates.clear();
+            for (int j = 0; j < n; j++)
+            {
+                if (j != i)
+                    candidates.push_back(j);
+            }
+            auto closer = [&](int a, int b)
+            { return dist[i][a] != dist[i][b] ? dist[i][a] < dist[i][b] : a < b; };
+            nth_element(candidates.begin(), candidates.begin() + neighbourCount - 1, candidates.end(), closer);
+            sort(candidates.begin(), candidates.begin() + neighbourCount, closer);
+            copy(candidates.begin(), candidates.begin() + neighbourCount, neighbours.begin() + (size_t)i * neighbourCount);
+        }
+    }
+
+    // 2-opt for city a: drop (a, succ a) and (c, succ c) for a near neighbour c,
+    // in both walking directions. Neighbours are sorted, so the scan stops once
+    // d(a,c) is no shorter than the edge being removed.
+    bool tryTwoOpt(TourArray &t, int a, deque<int> &queue, vector<char> &queued)
+    {
+        for (int forward = 1; forward >= 0; forward--)
+        {
+            int b = forward ? t.next(a) : t.prev(a);
+            long long ab = distance(a, b);
+            const int *near = &neighbours[(size_t)a * neighbourCount];
+            for (int k = 0; k < neighbourCount; k++)
+            {
+                int c = near[k];
+                long long ac = distance(a, c);
+                if (ac >= ab)
+                    break;
+                int d = forward ? t.next(c) : t.prev(c);
+                if (c == b || d == a)
+                    continue;
+                long long gain = ab + distance(c, d) - ac - distance(b, d);
+                if (gain > 0)
+                {
+                    t.move(a, b, c);
+                    activate(queue, queued, {a, b, c, d});
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Or-opt: move the segment of 1..OR_OPT_MAX_SEGMENT cities starting at a
+    // (in either walking direction) between a neighbour c and the city after it,
+    // as one or two 2-opt moves plus an optional flip of the segment.
+    bool tryOrOpt(TourArray &t, int a, deque<int> &queue, vector<char> &queued)
+    {
+        int size = t.size();
+        for (int forward = 1; forward >= 0; forward--)
+        {
+            auto step = [&](int v)
+            { return forward ? t.next(v) : t.prev(v); };
+            auto back = [&](int v)
+            { return forward ? t.prev(v) : t.next(v); };
+
+            int s1 = a, s2 = a;
+            for (int len = 1; len <= OR_OPT_MAX_SEGMENT && len + 3 <= size; len++, s2 = step(s2))
+            {
+                int p = back(s1), nx = step(s2);
+                long long removeGain = distance(p, s1) + distance(s2, nx) - distance(p, nx);
+                if (removeGain <= 0)
+                    continue;
+
+                for (int end = 0; end < 2; end++)
+                {
+                    int from = end ? s2 : s1;
+                    const int *near = &neighbours[(size_t)from * neighbourCount];
+                    for (int k = 0; k < neighbourCount; k++)
+                    {
+                        int c = near[k];
+                        if (distance(from, c) >= removeGain)
+                            break;
+                        // Insert between x and y = step(x), for both edges at c
+                        for (int side = 0; side < 2; side++)
+                        {
+                            int x = side ? back(c) : c;
+                            int y = step(x);
+                            bool inside = y == p; // that is moving p, not the segment
+                            for (int v = s1, i = 0; i < len; v = step(v), i++)
+                                inside = inside || v == x || v == y;
+                            if (inside)
+                                continue;
+
+                            long long xy = distance(x, y);
+                            long long keep = distance(x, s1) + distance(s2, y) - xy;
+                            long long flip = distance(x, s2) + distance(s1, y) - xy;
+                            if (removeGain - min(keep, flip) <= 0)
+                                continue;
+
+                            // p s1..s2 nx .. x y  ->  p x .. nx s2..s1 y  ->  p nx .. x s2..s1 y
+                            t.move(p, s1, x);
+                            t.move(p, x, nx);
+                            if (keep < flip)
+                                t.move(x, s2, s1);
+                            activate(queue, queued, {p, nx, s1, s2, x, y});
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    static void activate(deque<int> &queue, vector<char> &queued, initializer_list<int> cities)
+    {
+        for (int c : cities)
+        {
+            if (!queued[c])
+            {
+                queued[c] = 1;
+                queue.push_back(c);
+            }
+        }
+    }
+
+    // Local search over the current tour. A city leaves the work queue (its
+    // don't-look bit is set) when no move around it helps, and re-enters when a
+    // move changes one of its tour edges.
+    void improveTour()
+    {
+        if (n < 5)
+            return;
+        buildNeighbours();
+
+        TourArray t(vector<int>(tour.begin(), tour.end() - 1));
+        deque<int> queue(tour.begin(), tour.end() - 1);
+        vector<char> queued(n, 1);
+        while (!queue.empty())
+        {
+            int a = queue.front();
+            queue.pop_front();
+            queued[a] = 0;
+            if (tryTwoOpt(t, a, queue, queued) || tryOrOpt(t, a, queue, queued))
+                activate(queue, queued, {a});
+        }
+
+        tour = t.cycleFrom(0);
+        tourCost = 0;
+        for (size_t i = 0; i < tour.size() - 1; i++)
+            tourCost += distance(tour[i], tour[i + 1]);
+    }
+
+    // Edges from each city in `ids` to its k nearest others in `ids`, each pair
+    // once. Used instead of all pairs when the cities are points.
+    vector<Edge> nearestEdges(const vector<int> &ids, int k) const
     {
-        int px = find(x), py = find(y);
-        if (px == py)
-            return false;
-        if (rank[px] < rank[py])
-            swap(px, py);
-        parent[py] = px;
-        if (rank[px] == rank[py])
-            rank[px]++;
-        return true;
+        PointGrid grid(xs, ys, ids);
+        vector<Edge> edges;
+        edges.reserve(ids.size() * k);
+        vector<int> near;
+        for (int i : ids)
+        {
+            grid.nearest(i, k, near);
+            for (int j : near)
+                edges.push_back({min(i, j), max(i, j), (int)distance(i, j)});
+        }
+        sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b)
+             { return a.src != b.src ? a.src < b.src : a.dest < b.dest; });
+        edges.erase(unique(edges.begin(), edges.end(), [](const Edge &a, const Edge &b)
+                           { return a.src == b.src && a.dest == b.dest; }),
+                    edges.end());
+        return edges;
     }
-};
 
-class TSP_MST
-{
-private:
-    int n;
-    vector<vector<int>> dist;
-    vector<Edge> mstEdges;
-    vector<int> tour;
-    int tourCost;
+    // Exact Euclidean MST for coordinate input, in O(n) memory. Each Boruvka
+    // round gives every component its closest pair to another component. A
+    // city's nearest candidates answer that for it unless all of them are in its
+    // own component; then the grid is searched, skipping cells that only hold
+    // that component, unless its farthest candidate is already no closer than
+    // the best pair the component has. Pairs compare strictly (PointPair), so no
+    // round can close a cycle. Rounded distances never reorder pairs, so this is
+    // also the MST the integer weights give.
+    void boruvkaMST()
+    {
+        mstEdges.clear();
+        if (n < 2)
+            return;
+
+        vector<int> all(n);
+        for (int i = 0; i < n; i++)
+            all[i] = i;
+        PointGrid grid(xs, ys, all);
+
+        int k = min(CANDIDATE_NEIGHBOURS, n - 1);
+        vector<int> candidates((size_t)n * k), near;
+        vector<double> reachSq(n); // squared distance to the farthest candidate
+        auto squaredDistance = [&](int a, int b)
+        {
+            double dx = xs[a] - xs[b], dy = ys[a] - ys[b];
+            return dx * dx + dy * dy;
+        };
+        for (int i = 0; i < n; i++)
+        {
+            grid.nearest(i, k, near);
+            copy(near.begin(), near.end(), candidates.begin() + (size_t)i * k);
+            reachSq[i] = squaredDistance(i, near.back());
+        }
+
+        const PointPair none = {numeric_limits<double>::infinity(), -1, -1};
+        UnionFind uf(n);
+        vector<int> comp(n), searchGrid;
+        vector<PointPair> best(n);
+        int components = n;
+        while (components > 1)
+        {
+            for (int i = 0; i < n; i++)
+                comp[i] = uf.find(i);
+            grid.labelComponents(comp);
+            fill(best.begin(), best.end(), none);
+
+            searchGrid.clear();
+            for (int i = 0; i < n; i++)
+            {
+                bool answered = false;
+                for (int c = 0; c < k; c++)
+                {
+                    int j = candidates[(size_t)i * k + c];
+                    if (comp[j] == comp[i])
+                        continue;
+                    // Cities just as far as the farthest candidate may be missing
+                    double d2 = squaredDistance(i, j);
+                    if (d2 < reachSq[i])
+                    {
+                        PointPair pair = {d2, min(i, j), max(i, j)};
+                        best[comp[i]] = min(best[comp[i]], pair);
+                        best[comp[j]] = min(best[comp[j]], pair);
+                        answered = true;
+                    }
+                    break;
+                }
+                if (!answered)
+                    searchGrid.push_back(i);
+            }
+            for (int i : searchGrid)
+            {
+                if (reachSq[i] <= best[comp[i]].d2)
+                    grid.nearestForeign(i, comp, best[comp[i]]);
+            }
+
+            for (int r = 0; r < n; r++)
+            {
+                if (comp[r] != r || best[r].a < 0)
+                    continue;
+                if (uf.unite(best[r].a, best[r].b))
+                {
+                    mstEdges.push_back({best[r].a, best[r].b, (int)distance(best[r].a, best[r].b)});
+                    components--;
+                }
+            }
+        }
+
+        sort(mstEdges.begin(), mstEdges.end(), [](const Edge &a, const Edge &b)
+             { return a.weight != b.weight ? a.weight < b.weight
+                                           : (a.src != b.src ? a.src < b.src : a.dest < b.dest); });
+    }
 
     void kruskalMST()
     {
@@ -77,7 +1079,11 @@ private:
                 }
             }
         }
+        kruskalOver(edges);
+    }
 
+    void kruskalOver(vector<Edge> &edges)
+    {
         sort(edges.begin(), edges.end());
         UnionFind uf(n);
         mstEdges.clear();
@@ -87,87 +1093,363 @@ private:
             if (uf.unite(e.src, e.dest))
             {
                 mstEdges.push_back(e);
-                if (mstEdges.size() == n - 1)
+                if ((int)mstEdges.size() == n - 1)
                     break;
             }
         }
     }
 
-    // Preorder traversal (DFS) on the MST
-    void dfs(int node, vector<vector<int>> &adj, vector<bool> &visited)
+    // Array-based Prim: each step picks the closest city outside the tree and
+    // relaxes its matrix row, so the only extra memory is three arrays of V.
+    // When nothing else is reachable it starts a new tree at the lowest remaining
+    // city, giving the same spanning forest as Kruskal on a disconnected graph.
+    void primMST()
     {
-        visited[node] = true;
-        tour.push_back(node);
+        vector<int> key(n, INF), parent(n, -1);
+        vector<bool> inTree(n, false);
+        mstEdges.clear();
 
-        for (int neighbor : adj[node])
+        for (int added = 0; added < n; added++)
         {
-            if (!visited[neighbor])
+            int u = -1;
+            for (int v = 0; v < n; v++)
+            {
+                if (!inTree[v] && (u < 0 || key[v] < key[u]))
+                    u = v;
+            }
+            inTree[u] = true;
+            if (parent[u] >= 0)
+                mstEdges.push_back({min(parent[u], u), max(parent[u], u), key[u]});
+
+            const vector<int> &row = dist[u];
+            for (int v = 0; v < n; v++)
             {
-                dfs(neighbor, adj, visited);
+                if (!inTree[v] && row[v] != INF && row[v] < key[v])
+                {
+                    key[v] = row[v];
+                    parent[v] = u;
+                }
             }
         }
+
+        // List the edges as Kruskal would: by weight, ties by endpoints
+        sort(mstEdges.begin(), mstEdges.end(), [](const Edge &a, const Edge &b)
+             { return a.weight != b.weight ? a.weight < b.weight
+                                           : (a.src != b.src ? a.src < b.src : a.dest < b.dest); });
     }
 
-    void constructTour()
+    bool usePrim() const
+    {
+        if (hasCoordinates) // Prim would need every pair; Kruskal uses nearby ones
+            return false;
+        if (mstMethod != MST_AUTO)
+            return mstMethod == MST_PRIM;
+        long long finite = 0;
+        for (int i = 0; i < n; i++)
+        {
+            for (int j = i + 1; j < n; j++)
+                finite += (dist[i][j] != INF);
+        }
+        return finite >= PRIM_DENSITY * ((double)n * (n - 1) / 2);
+    }
+
+    // Adjacency of an edge list in CSR form: the neighbours of v are
+    // target[start[v] .. start[v+1]), in the order the edges were listed, and
+    // edgeId says which input edge each entry came from.
+    struct Adjacency
+    {
+        vector<int> start, target, edgeId;
+    };
+
+    Adjacency buildAdjacency(const vector<Edge> &edges) const
+    {
+        Adjacency adj;
+        adj.start.assign(n + 1, 0);
+        for (const Edge &e : edges)
+        {
+            adj.start[e.src + 1]++;
+            adj.start[e.dest + 1]++;
+        }
+        for (int v = 0; v < n; v++)
+            adj.start[v + 1] += adj.start[v];
+        adj.target.resize(2 * edges.size());
+        adj.edgeId.resize(2 * edges.size());
+        vector<int> fill(adj.start.begin(), adj.start.end() - 1);
+        for (size_t i = 0; i < edges.size(); i++)
+        {
+            const Edge &e = edges[i];
+            adj.target[fill[e.src]] = e.dest;
+            adj.edgeId[fill[e.src]++] = i;
+            adj.target[fill[e.dest]] = e.src;
+            adj.edgeId[fill[e.dest]++] = i;
+        }
+        return adj;
+    }
+
+    // Minimum-weight perfect matching on the odd-degree vertices: exact via the
+    // blossom algorithm (weights turned into C - d so that a maximum-weight
+    // matching is perfect and of minimum distance), or greedy over all pairs
+    // sorted by distance when there are too many of them.
+    vector<Edge> matchOddVertices(const vector<int> &odd, bool exact)
+    {
+        int k = odd.size();
+        vector<Edge> matching;
+        if (exact)
+        {
+            long long maxD = 0;
+            for (int i = 0; i < k; i++)
+                for (int j = i + 1; j < k; j++)
+                    maxD = max(maxD, distance(odd[i], odd[j]));
+            long long C = maxD * (k / 2) + 1;
+            WeightedMatching m(k);
+            for (int i = 0; i < k; i++)
+                for (int j = i + 1; j < k; j++)
+                    m.addEdge(i + 1, j + 1, C - distance(odd[i], odd[j]));
+            m.solve();
+            for (int i = 0; i < k; i++)
+            {
+                int j = m.mate(i + 1) - 1;
+                if (j > i)
+                    matching.push_back({odd[i], odd[j], (int)distance(odd[i], odd[j])});
+            }
+            return matching;
+        }
+
+        // Points: greedy over nearby pairs first, then over all pairs of
+        // whatever is left unmatched, which is normally a handful of vertices.
+        vector<bool> matched(n, false);
+        vector<int> left = odd;
+        if (hasCoordinates && k > 2 * CANDIDATE_NEIGHBOURS)
+        {
+            vector<Edge> pairs = nearestEdges(odd, CANDIDATE_NEIGHBOURS);
+            greedyMatch(pairs, matched, matching);
+            left.clear();
+            for (int v : odd)
+            {
+                if (!matched[v])
+                    left.push_back(v);
+            }
+        }
+
+        vector<Edge> pairs;
+        pairs.reserve(left.size() * (left.size() - 1) / 2);
+        for (size_t i = 0; i < left.size(); i++)
+            for (size_t j = i + 1; j < left.size(); j++)
+                pairs.push_back({left[i], left[j], (int)distance(left[i], left[j])});
+        greedyMatch(pairs, matched, matching);
+        return matching;
+    }
+
+    static void greedyMatch(vector<Edge> &pairs, vector<bool> &matched, vector<Edge> &matching)
+    {
+        sort(pairs.begin(), pairs.end());
+        for (const Edge &e : pairs)
+        {
+            if (!matched[e.src] && !matched[e.dest])
+            {
+                matched[e.src] = matched[e.dest] = true;
+                matching.push_back(e);
+            }
+        }
+    }
+
+    // Christofides: MST + matching on its odd-degree vertices gives an Eulerian
+    // multigraph; walk an Euler circuit (iterative Hierholzer) and skip cities
+    // already visited.
+    void christofides()
     {
-        // Build adjacency list for the MST
-        vector<vector<int>> adj(n);
+        vector<int> degree(n, 0);
         for (const Edge &e : mstEdges)
         {
-            adj[e.src].push_back(e.dest);
-            adj[e.dest].push_back(e.src);
+            degree[e.src]++;
+            degree[e.dest]++;
+        }
+        vector<int> odd;
+        for (int v = 0; v < n; v++)
+        {
+            if (degree[v] % 2 == 1)
+                odd.push_back(v);
         }
 
-        vector<bool> visited(n, false);
+        bool exact = (int)odd.size() <= exactMatchingLimit;
+        cout << "Step 2: Matching " << odd.size() << " odd-degree vertices ("
+             << (exact ? "exact blossom" : "greedy") << ")...\n";
+        vector<Edge> multigraph = mstEdges;
+        for (const Edge &e : matchOddVertices(odd, exact))
+            multigraph.push_back(e);
+
+        cout << "Step 3: Walking an Euler circuit and shortcutting repeated cities...\n";
+        Adjacency adj = buildAdjacency(multigraph);
+        vector<int> cursor(adj.start.begin(), adj.start.end() - 1);
+        vector<bool> usedEdge(multigraph.size(), false), seen(n, false);
+        vector<int> stack = {0};
         tour.clear();
-        
-        // Start DFS from City 0 (arbitrary start)
-        dfs(0, adj, visited);
-        
-        // Complete the Hamiltonian Cycle by returning to the start city
+        while (!stack.empty())
+        {
+            int v = stack.back();
+            while (cursor[v] < adj.start[v + 1] && usedEdge[adj.edgeId[cursor[v]]])
+                cursor[v]++;
+            if (cursor[v] == adj.start[v + 1])
+            {
+                // v is finished: it is the next city of the circuit, read backwards
+                stack.pop_back();
+                if (!seen[v])
+                {
+                    seen[v] = true;
+                    tour.push_back(v);
+                }
+            }
+            else
+            {
+                usedEdge[adj.edgeId[cursor[v]]] = true;
+                stack.push_back(adj.target[cursor[v]]);
+            }
+        }
+        // Cities finish in reverse circuit order, starting with 0 (the walk first
+        // gets stuck where it began); the reversed circuit is just as good.
         tour.push_back(0);
 
-        // Calculate the cost of the constructed tour
         tourCost = 0;
         for (size_t i = 0; i < tour.size() - 1; i++)
+            tourCost += distance(tour[i], tour[i + 1]);
+    }
+
+    // Preorder traversal (DFS) of the MST from City 0 with an explicit stack, so
+    // a path-shaped tree of any size cannot overflow the call stack. Neighbours
+    // are taken in mstEdges order, the order the recursive version used, and
+    // the tour cost is added up as cities are visited.
+    void constructTour()
+    {
+        Adjacency adj = buildAdjacency(mstEdges);
+        vector<int> cursor(adj.start.begin(), adj.start.end() - 1);
+        vector<bool> visited(n, false);
+        vector<int> stack = {0};
+        visited[0] = true;
+        tour.assign(1, 0);
+        tourCost = 0;
+
+        while (!stack.empty())
         {
-            tourCost += dist[tour[i]][tour[i + 1]];
+            int node = stack.back();
+            if (cursor[node] == adj.start[node + 1])
+            {
+                stack.pop_back();
+                continue;
+            }
+            int neighbor = adj.target[cursor[node]++];
+            if (!visited[neighbor])
+            {
+                visited[neighbor] = true;
+                tourCost += distance(tour.back(), neighbor);
+                tour.push_back(neighbor);
+                stack.push_back(neighbor);
+            }
         }
+
+        // Complete the Hamiltonian Cycle by returning to the start city
+        tourCost += distance(tour.back(), 0);
+        tour.push_back(0);
     }
 
 public:
-    TSP_MST(int cities) : n(cities), tourCost(0)
+    TSP_MST(int cities) : n(cities), hasCoordinates(false), tourCost(0), mstMethod(MST_AUTO), tourMethod(TOUR_MST_PREORDER),
+                           exactMatchingLimit(DEFAULT_EXACT_MATCHING_LIMIT), improve(false), neighbourCount(0)
     {
-        dist.resize(n, vector<int>(n));
     }
 
     void setGraph(const vector<vector<int>> &graph)
     {
         dist = graph;
+        hasCoordinates = false;
+    }
+
+    // Cities as points (TSPLIB EUC_2D): no matrix is stored, so memory stays O(n)
+    void setCoordinates(const vector<double> &x, const vector<double> &y)
+    {
+        xs = x;
+        ys = y;
+        hasCoordinates = true;
+        dist.clear();
+    }
+
+    void setMSTMethod(MSTMethod method)
+    {
+        mstMethod = method;
+    }
+
+    void setTourMethod(TourMethod method)
+    {
+        tourMethod = method;
+    }
+
+    void setExactMatchingLimit(int vertices)
+    {
+        exactMatchingLimit = vertices;
+    }
+
+    void setImprove(bool enabled)
+    {
+        improve = enabled;
     }
 
     void solve()
     {
-        cout << "\nStep 1: Constructing MST using Kruskal's Algorithm...\n";
-        kruskalMST();
+        if (hasCoordinates)
+        {
+            cout << "\nStep 1: Constructing MST using Boruvka's Algorithm over the point grid...\n";
+            boruvkaMST();
+        }
+        else if (usePrim())
+        {
+            cout << "\nStep 1: Constructing MST using Prim's Algorithm (dense matrix)...\n";
+            primMST();
+        }
+        else
+        {
+            cout << "\nStep 1: Constructing MST using Kruskal's Algorithm...\n";
+            kruskalMST();
+        }
+
+        if (tourMethod == TOUR_CHRISTOFIDES && (int)mstEdges.size() == n - 1)
+        {
+            if (!isSymmetric())
+                cout << "Note: the matrix is not symmetric, so Christofides' 1.5 bound does not hold for this tour.\n";
+            christofides();
+        }
+        else
+        {
+            if (tourMethod == TOUR_CHRISTOFIDES)
+                cout << "The graph is disconnected; Christofides needs a spanning tree, using the MST tour.\n";
+
+            cout << "Step 2: Performing DFS (Preorder Traversal) on MST...\n";
+            constructTour();
 
-        cout << "Step 2: Performing DFS (Preorder Traversal) on MST...\n";
-        constructTour();
+            cout << "Step 3: Forming Hamiltonian Cycle...\n";
+        }
 
-        cout << "Step 3: Forming Hamiltonian Cycle...\n";
+        if (improve)
+        {
+            if (isSymmetric())
+            {
+                cout << "Step 4: Improving the tour with 2-opt and Or-opt...\n";
+                improveTour();
+            }
+            else
+            {
+                cout << "Step 4: Skipped, 2-opt and Or-opt need a symmetric matrix.\n";
+            }
+        }
     }
 
     void displayMST()
     {
         cout << "\n=== Minimum Spanning Tree ===\n";
-        int mstWeight = 0;
         for (const Edge &e : mstEdges)
         {
             cout << "Edge: " << e.src << " -- " << e.dest
                  << "  Weight: " << e.weight << "\n";
-            mstWeight += e.weight;
         }
-        cout << "Total MST Weight: " << mstWeight << "\n";
+        cout << "Total MST Weight: " << getMSTWeight() << "\n";
     }
 
     void displayTour()
@@ -186,12 +1468,22 @@ public:
         for (size_t i = 0; i < tour.size() - 1; i++)
         {
             cout << "  City " << tour[i] << " to City " << tour[i + 1]
-                 << " : " << dist[tour[i]][tour[i + 1]] << "\n";
+                 << " : " << distance(tour[i], tour[i + 1]) << "\n";
         }
     }
 
     void displayGraph()
     {
+        if (hasCoordinates)
+        {
+            cout << "\n=== City Coordinates (EUC_2D) ===\n";
+            for (int i = 0; i < n && i < 20; i++)
+                cout << "C" << i << " | (" << xs[i] << ", " << ys[i] << ")\n";
+            if (n > 20)
+                cout << "... " << n - 20 << " more cities\n";
+            return;
+        }
+
         cout << "\n=== Distance Matrix ===\n";
         cout << "     ";
         for (int i = 0; i < n; i++)
@@ -219,69 +1511,224 @@ public:
         }
     }
 
-    int getTourCost() const { return tourCost; }
+    long long getTourCost() const { return tourCost; }
+
+    long long getMSTWeight() const
+    {
+        long long weight = 0;
+        for (const Edge &e : mstEdges)
+            weight += e.weight;
+        return weight;
+    }
 };
 
-// 🆕 New function to handle file input
+// Ask for the optional improvement stage, then solve and print the results.
+void solveAndShow(TSP_MST &tsp) {
+    int method;
+    cout << "\nTour construction (1 = MST preorder, 2 = Christofides): ";
+    bool christofides = cin >> method && method == 2;
+    if (christofides) {
+        tsp.setTourMethod(TOUR_CHRISTOFIDES);
+        int limit;
+        cout << "Exact matching for up to how many odd-degree cities (0 = default "
+             << DEFAULT_EXACT_MATCHING_LIMIT << "): ";
+        if (cin >> limit && limit > 0) {
+            tsp.setExactMatchingLimit(limit);
+        }
+    }
+
+    char choice;
+    cout << "\nImprove the tour with 2-opt and Or-opt? (y/n): ";
+    cin >> choice;
+    tsp.setImprove(choice == 'y' || choice == 'Y');
+
+    cout << "\n================================================\n";
+    if (christofides) {
+        cout << "Solving TSP using Christofides (1.5-Approximation)...\n";
+    } else {
+        cout << "Solving TSP using MST-based 2-Approximation...\n";
+    }
+    cout << "================================================\n";
+
+    tsp.solve();
+    tsp.displayMST();
+    tsp.displayTour();
+}
+
+// Read the text matrix format: the number of cities on the first line, then the
+// N x N matrix one row per line.
+bool loadTextGraph(const string& filename, vector<vector<int>>& graph) {
+    TextMatrixReader reader;
+    if (!reader.open(filename)) {
+        cout << "**Error:** " << reader.message("cities") << endl;
+        return false;
+    }
+
+    int n = reader.vertices();
+    graph.assign(n, vector<int>(n));
+    if (!reader.readRows<int>([&](int i) { return graph[i].data(); })) {
+        cout << "**Error:** " << reader.message("cities") << endl;
+        return false;
+    }
+    return true;
+}
+
+// TSPLIB files start with keyword lines (NAME, TYPE, DIMENSION, ...), the text
+// matrix format with the number of cities.
+bool isTsplibFile(const string& filename) {
+    FILE* f = fopen(filename.c_str(), "rb");
+    if (f == nullptr) return false;
+    int c;
+    while ((c = fgetc(f)) != EOF && isspace(c)) {
+    }
+    fclose(f);
+    return c != EOF && isalpha(c);
+}
+
+// Read a TSPLIB instance with EUC_2D coordinates: "KEY : value" lines up to
+// NODE_COORD_SECTION, then one "index x y" line per city (indices 1..n).
+bool loadTsplibCoordinates(const string& filename, vector<double>& x, vector<double>& y) {
+    MappedFile map;
+    if (!map.open(filename, false)) {
+        cout << "**Error:** Could not open file: " << filename << endl;
+        return false;
+    }
+
+    const char* p = map.data();
+    const char* end = p + map.size();
+    auto skipBlanks = [&](const char*& q, const char* stop) {
+        while (q < stop && (*q == ' ' || *q == '\t' || *q == '\r')) q++;
+    };
+
+    long long n = -1, found = 0;
+    bool inCoords = false;
+    vector<bool> seen;
+    while (p < end) {
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (lineEnd == nullptr) lineEnd = end;
+        const char* q = p;
+        p = (lineEnd == end) ? end : lineEnd + 1;
+        skipBlanks(q, lineEnd);
+        if (q == lineEnd) continue;
+
+        if (!inCoords || isalpha((unsigned char)*q)) {
+            const char* keyEnd = q;
+            while (keyEnd < lineEnd && (isalnum((unsigned char)*keyEnd) || *keyEnd == '_')) keyEnd++;
+            string key(q, keyEnd);
+            const char* v = keyEnd;
+            skipBlanks(v, lineEnd);
+            if (v < lineEnd && *v == ':') v++;
+            skipBlanks(v, lineEnd);
+            string value(v, lineEnd);
+            while (!value.empty() && isspace((unsigned char)value.back())) value.pop_back();
+
+            if (key == "EOF") break;
+            if (key == "DIMENSION") {
+                auto parsed = from_chars(value.data(), value.data() + value.size(), n);
+                if (parsed.ec != errc() || n <= 0 || n > INT_MAX) {
+                    cout << "**Error:** Invalid DIMENSION: " << value << endl;
+                    return false;
+                }
+            } else if (key == "EDGE_WEIGHT_TYPE" && value != "EUC_2D") {
+                cout << "**Error:** Only EUC_2D coordinates are supported (found " << value << ")." << endl;
+                return false;
+            } else if (key == "NODE_COORD_SECTION") {
+                if (n < 0) {
+                    cout << "**Error:** Missing DIMENSION before NODE_COORD_SECTION." << endl;
+                    return false;
+                }
+                x.assign(n, 0);
+                y.assign(n, 0);
+                seen.assign(n, false);
+                inCoords = true;
+            } else if (inCoords) {
+                break; // another section follows the coordinates
+            }
+            continue;
+        }
+
+        long long id;
+        double px, py;
+        auto a = from_chars(q, lineEnd, id);
+        const char* r = a.ptr;
+        skipBlanks(r, lineEnd);
+        auto b = from_chars(r, lineEnd, px);
+        r = b.ptr;
+        skipBlanks(r, lineEnd);
+        auto c = from_chars(r, lineEnd, py);
+        if (a.ec != errc() || b.ec != errc() || c.ec != errc() || id < 1 || id > n || seen[id - 1]) {
+            cout << "**Error:** Invalid coordinate line " << found + 1 << " in NODE_COORD_SECTION." << endl;
+            return false;
+        }
+        seen[id - 1] = true;
+        x[id - 1] = px;
+        y[id - 1] = py;
+        found++;
+    }
+
+    if (!inCoords) {
+        cout << "**Error:** No NODE_COORD_SECTION found." << endl;
+        return false;
+    }
+    if (found != n) {
+        cout << "**Error:** Expected " << n << " cities in NODE_COORD_SECTION, found " << found << "." << endl;
+        return false;
+    }
+    return true;
+}
+
+// 🆕 New function to handle file input (text matrix, binary file from
+// matrix_convert, or TSPLIB EUC_2D coordinates)
 void useFileGraph() {
     string filename;
     cout << "\nEnter the filename containing the graph data (e.g., graph.txt): ";
     cin >> filename;
 
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cout << "**Error:** Could not open file: " << filename << endl;
+    if (!isMatrixFile(filename) && isTsplibFile(filename)) {
+        vector<double> x, y;
+        if (!loadTsplibCoordinates(filename, x, y)) {
+            return;
+        }
+        int n = x.size();
+        if (n < 2) {
+            cout << "**Error:** Number of cities must be at least 2!\n";
+            return;
+        }
+
+        cout << "\nCoordinates loaded successfully from " << filename << " (" << n << " cities)." << endl;
+
+        TSP_MST tsp(n);
+        tsp.setCoordinates(x, y);
+        tsp.displayGraph();
+
+        solveAndShow(tsp);
         return;
     }
 
-    int n;
-    // Read the number of cities (V) from the first line
-    if (!(file >> n) || n <= 0) {
-        cout << "**Error:** Invalid or missing number of cities in the first line." << endl;
+    vector<vector<int>> graph;
+    if (isMatrixFile(filename)) {
+        string error;
+        if (!loadMatrixFileRows(filename, graph, (int)INF, error)) {
+            cout << "**Error:** " << error << endl;
+            return;
+        }
+    } else if (!loadTextGraph(filename, graph)) {
         return;
     }
 
+    int n = graph.size();
     if (n < 2) {
         cout << "**Error:** Number of cities must be at least 2!\n";
         return;
     }
 
-    TSP_MST tsp(n);
-    vector<vector<int>> graph(n, vector<int>(n));
-    string line;
-    
-    // Consume the rest of the first line
-    getline(file, line); 
-
-    // Read the N x N matrix
-    for (int i = 0; i < n; i++) {
-        if (!getline(file, line)) {
-            cout << "**Error:** File ended unexpectedly. Expected " << n << " rows for the matrix." << endl;
-            return;
-        }
-        stringstream ss(line);
-        for (int j = 0; j < n; j++) {
-            int weight;
-            if (!(ss >> weight)) {
-                cout << "**Error:** Missing weight at row " << i << ", column " << j << "." << endl;
-                return;
-            }
-            graph[i][j] = weight;
-        }
-    }
-
     cout << "\nGraph loaded successfully from " << filename << " (" << n << " cities)." << endl;
     
+    TSP_MST tsp(n);
     tsp.setGraph(graph);
     tsp.displayGraph();
 
-    cout << "\n================================================\n";
-    cout << "Solving TSP using MST-based 2-Approximation...\n";
-    cout << "================================================\n";
-
-    tsp.solve();
-    tsp.displayMST();
-    tsp.displayTour();
+    solveAndShow(tsp);
 }
 
 void testCase1() {
@@ -298,9 +1745,7 @@ void testCase1() {
     TSP_MST tsp(6);
     tsp.setGraph(graph);
     tsp.displayGraph();
-    tsp.solve();
-    tsp.displayMST();
-    tsp.displayTour();
+    solveAndShow(tsp);
 }
 
 void testCase2() {
@@ -319,9 +1764,7 @@ void testCase2() {
     TSP_MST tsp(8);
     tsp.setGraph(graph);
     tsp.displayGraph();
-    tsp.solve();
-    tsp.displayMST();
-    tsp.displayTour();
+    solveAndShow(tsp);
 }
 
 void testCase3() {
@@ -342,9 +1785,7 @@ void testCase3() {
     TSP_MST tsp(10);
     tsp.setGraph(graph);
     tsp.displayGraph();
-    tsp.solve();
-    tsp.displayMST();
-    tsp.displayTour();
+    solveAndShow(tsp);
 }
 
 void runTests() {
@@ -384,20 +1825,16 @@ void customInput() {
     tsp.setGraph(graph);
     tsp.displayGraph();
 
-    cout << "\n================================================\n";
-    cout << "Solving TSP using MST-based 2-Approximation...\n";
-    cout << "================================================\n";
-
-    tsp.solve();
-    tsp.displayMST();
-    tsp.displayTour();
+    solveAndShow(tsp);
 }
 
+// Tests include this file with P3_NO_MAIN defined to reach TSP_MST directly.
+#ifndef P3_NO_MAIN
 int main()
 {
     cout << "================================================\n";
     cout << "  TSP APPROXIMATION USING MST\n";
-    cout << "  (2-Approximation Algorithm)\n";
+    cout << "  (MST 2-Approximation or Christofides)\n";
     cout << "================================================\n";
 
     int choice;
@@ -427,4 +1864,5 @@ int main()
     }
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
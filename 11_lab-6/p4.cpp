@@ -2,167 +2,675 @@
 #include <vector>
 #include <set>
 #include <map>
+#include <unordered_set>
 #include <algorithm>
 #include <sstream>
 #include <fstream> // Required for file operations
+#include <cstdint>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <numeric>
+#include <limits>
+#include <chrono>
+
+#include "matrix_file.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define P4_X86_SIMD 1
+#endif
 
 using namespace std;
 
-// Function to approximate Set Cover using greedy algorithm
-set<int> approximateSetCover(vector<set<int>>& subsets, set<int>& universe) {
-    set<int> result;
-    set<int> uncovered = universe;
-    
-    while (!uncovered.empty()) {
-        // Find the subset that covers the maximum number of uncovered elements
-        int maxCover = -1;
-        int bestSubset = -1;
-        
-        for (int i = 0; i < subsets.size(); i++) {
-            int coverCount = 0;
-            for (int element : subsets[i]) {
-                if (uncovered.find(element) != uncovered.end()) {
-                    coverCount++;
-                }
+// Set cover instance with elements compacted to 0..elementCount-1 and the
+// subsets stored back to back: subset i is members[offsets[i] .. offsets[i + 1])
+struct SetCoverInstance {
+    int elementCount = 0;
+    vector<int> offsets{0};
+    vector<int> members;
+
+    int subsetCount() const { return (int)offsets.size() - 1; }
+};
+
+// popcount(a[w] & b[w]) summed over `words` words. All variants compute the
+// same count
+typedef int (*AndPopcountFn)(const uint64_t* a, const uint64_t* b, int words);
+
+static int andPopcountScalar(const uint64_t* a, const uint64_t* b, int words) {
+    int count = 0;
+    for (int w = 0; w < words; w++) {
+        uint64_t x = a[w] & b[w];
+        x = x - ((x >> 1) & 0x5555555555555555ULL);
+        x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        count += (int)((x * 0x0101010101010101ULL) >> 56);
+    }
+    return count;
+}
+
+#ifdef P4_X86_SIMD
+__attribute__((target("popcnt")))
+static int andPopcountPOPCNT(const uint64_t* a, const uint64_t* b, int words) {
+    long long count = 0;
+    for (int w = 0; w < words; w++) {
+        count += __builtin_popcountll(a[w] & b[w]);
+    }
+    return (int)count;
+}
+
+// 4 words per step: split bytes into nibbles, look their bit counts up with a
+// byte shuffle, then sum the bytes of each 64-bit lane with SAD against zero
+__attribute__((target("avx2")))
+static int andPopcountAVX2(const uint64_t* a, const uint64_t* b, int words) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+    __m256i total = _mm256_setzero_si256();
+    int w = 0;
+    for (; w + 4 <= words; w += 4) {
+        __m256i x = _mm256_and_si256(_mm256_loadu_si256((const __m256i*)(a + w)),
+                                     _mm256_loadu_si256((const __m256i*)(b + w)));
+        __m256i lo = _mm256_shuffle_epi8(lookup, _mm256_and_si256(x, lowNibbles));
+        __m256i hi = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(x, 4), lowNibbles));
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(_mm256_add_epi8(lo, hi), _mm256_setzero_si256()));
+    }
+    alignas(32) long long lanes[4];
+    _mm256_store_si256((__m256i*)lanes, total);
+    long long count = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    return (int)count + andPopcountScalar(a + w, b + w, words - w);
+}
+#endif
+
+// Pick the widest kernel the running CPU supports.
+static AndPopcountFn selectAndPopcount(const char** name) {
+#ifdef P4_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "AVX2";
+        return andPopcountAVX2;
+    }
+    if (__builtin_cpu_supports("popcnt")) {
+        *name = "POPCNT";
+        return andPopcountPOPCNT;
+    }
+#endif
+    *name = "scalar";
+    return andPopcountScalar;
+}
+
+// Bitset subsets are only worth it for a small universe whose subsets are
+// dense enough that scanning every word beats visiting the members one by one
+const int BITSET_MAX_ELEMENTS = 1 << 16;
+const int BITSET_MIN_MEMBERS_PER_WORD = 2;
+const size_t BITSET_MAX_BYTES = (size_t)256 << 20;
+
+bool useBitsetSubsets(const SetCoverInstance& instance) {
+    if (instance.elementCount == 0 || instance.elementCount > BITSET_MAX_ELEMENTS) return false;
+    size_t words = (instance.elementCount + 63) / 64;
+    if (words * 8 * instance.subsetCount() > BITSET_MAX_BYTES) return false;
+    return instance.members.size() >= BITSET_MIN_MEMBERS_PER_WORD * words * instance.subsetCount();
+}
+
+// Lazy greedy: gains only ever shrink as elements get covered, so a subset's
+// last computed gain is an upper bound. Keep subsets in a max-heap keyed by that
+// bound and only recompute the gain of the subset on top; if it still beats
+// the next bound it is the true maximum. Ties go to the smaller index, which
+// picks exactly the same subsets as a full rescan every round.
+// With costs the key is gain / cost (newly covered elements per unit cost),
+// which is the same upper bound argument; without them it is the plain gain.
+// take(s) marks subset s covered and returns how many elements it newly covered
+template <typename GainFn, typename TakeFn>
+vector<int> lazyGreedy(int subsetCount, int remaining, const vector<double>& costs, GainFn gainOf, TakeFn take) {
+    auto keyOf = [&](int s, int gain) {
+        if (costs.empty()) return (double)gain;
+        return costs[s] > 0 ? gain / costs[s] : numeric_limits<double>::infinity();
+    };
+
+    // Heap entries are (key, -index) so equal keys pop the smaller index first
+    vector<pair<double, int>> heap;
+    heap.reserve(subsetCount);
+    for (int s = 0; s < subsetCount; s++) {
+        int gain = gainOf(s);
+        if (gain > 0) heap.push_back({keyOf(s, gain), -s});
+    }
+    make_heap(heap.begin(), heap.end());
+
+    vector<int> chosen;
+    while (remaining > 0 && !heap.empty()) {
+        pop_heap(heap.begin(), heap.end());
+        pair<double, int> top = heap.back();
+        heap.pop_back();
+
+        int s = -top.second;
+        int gain = gainOf(s);
+        if (gain == 0) continue;
+
+        pair<double, int> fresh(keyOf(s, gain), -s);
+        if (!heap.empty() && fresh < heap.front()) {
+            // Stale: put it back with the fresh key
+            heap.push_back(fresh);
+            push_heap(heap.begin(), heap.end());
+            continue;
+        }
+
+        chosen.push_back(s);
+        remaining -= take(s);
+    }
+    return chosen;
+}
+
+// Greedy set cover over the instance. Uncovered elements live in a bitmap;
+// gains come either from the member lists or, for small dense universes, from
+// popcount(subset & uncovered) over per-subset bitsets. `kernel` reports which.
+// Empty `costs` means every subset costs 1
+vector<int> lazyGreedySetCover(const SetCoverInstance& instance, const vector<double>& costs = {},
+                               const char** kernel = nullptr) {
+    int words = (instance.elementCount + 63) / 64;
+    vector<uint64_t> uncovered(words, ~0ULL);
+    if (instance.elementCount % 64) {
+        uncovered.back() = (1ULL << (instance.elementCount % 64)) - 1;
+    }
+
+    if (useBitsetSubsets(instance)) {
+        const char* name;
+        AndPopcountFn andPopcount = selectAndPopcount(&name);
+        if (kernel) *kernel = name;
+
+        vector<uint64_t> bits((size_t)words * instance.subsetCount(), 0);
+        for (int s = 0; s < instance.subsetCount(); s++) {
+            uint64_t* row = bits.data() + (size_t)s * words;
+            for (int k = instance.offsets[s]; k < instance.offsets[s + 1]; k++) {
+                row[instance.members[k] >> 6] |= 1ULL << (instance.members[k] & 63);
             }
-            
-            if (coverCount > maxCover) {
-                maxCover = coverCount;
-                bestSubset = i;
+        }
+
+        auto gainOf = [&](int s) { return andPopcount(bits.data() + (size_t)s * words, uncovered.data(), words); };
+        auto take = [&](int s) {
+            int gain = gainOf(s);
+            const uint64_t* row = bits.data() + (size_t)s * words;
+            for (int w = 0; w < words; w++) uncovered[w] &= ~row[w];
+            return gain;
+        };
+        return lazyGreedy(instance.subsetCount(), instance.elementCount, costs, gainOf, take);
+    }
+
+    if (kernel) *kernel = "sparse";
+    auto gainOf = [&](int s) {
+        int gain = 0;
+        for (int k = instance.offsets[s]; k < instance.offsets[s + 1]; k++) {
+            int e = instance.members[k];
+            gain += (int)((uncovered[e >> 6] >> (e & 63)) & 1);
+        }
+        return gain;
+    };
+    auto take = [&](int s) {
+        int covered = 0;
+        for (int k = instance.offsets[s]; k < instance.offsets[s + 1]; k++) {
+            int e = instance.members[k];
+            uint64_t bit = 1ULL << (e & 63);
+            if (uncovered[e >> 6] & bit) {
+                uncovered[e >> 6] &= ~bit;
+                covered++;
             }
         }
-        
-        if (bestSubset == -1) break; // No more subsets can cover remaining elements
-        
-        // Add the best subset to result and remove covered elements
-        result.insert(bestSubset);
-        for (int element : subsets[bestSubset]) {
-            uncovered.erase(element);
+        return covered;
+    };
+    return lazyGreedy(instance.subsetCount(), instance.elementCount, costs, gainOf, take);
+}
+
+double coverCost(const vector<int>& chosen, const vector<double>& costs) {
+    double total = 0;
+    for (int s : chosen) total += costs.empty() ? 1.0 : costs[s];
+    return total;
+}
+
+// Local search on a finished cover, driven by per-element coverage counters so
+// every check is O(|S|):
+//  - drop redundant subsets (every element covered twice), most expensive first
+//  - swap: add an unused subset, drop every chosen subset that became
+//    redundant, and keep the move if the dropped cost beats the added cost
+// Swap passes repeat until one finds nothing or `seconds` run out.
+// `chosen` comes back sorted
+void refineSetCover(const SetCoverInstance& instance, const vector<double>& costs,
+                    vector<int>& chosen, double seconds) {
+    const double EPS = 1e-9;
+    auto deadline = chrono::steady_clock::now() + chrono::duration<double>(seconds);
+    auto costOf = [&](int s) { return costs.empty() ? 1.0 : costs[s]; };
+    auto membersOf = [&](int s) {
+        return make_pair(instance.members.begin() + instance.offsets[s],
+                         instance.members.begin() + instance.offsets[s + 1]);
+    };
+
+    int subsetCount = instance.subsetCount();
+    vector<int> coverCount(instance.elementCount, 0);
+    vector<char> inCover(subsetCount, 0);
+    for (int s : chosen) {
+        inCover[s] = 1;
+        for (auto [it, end] = membersOf(s); it != end; ++it) coverCount[*it]++;
+    }
+
+    // Drop each candidate that is redundant at its turn; returns the dropped ones
+    vector<int> dropped;
+    auto dropRedundant = [&](vector<int>& candidates) {
+        sort(candidates.begin(), candidates.end(), [&](int a, int b) {
+            return costOf(a) != costOf(b) ? costOf(a) > costOf(b) : a > b;
+        });
+        dropped.clear();
+        for (int s : candidates) {
+            auto [first, end] = membersOf(s);
+            if (!all_of(first, end, [&](int e) { return coverCount[e] >= 2; })) continue;
+            for (auto it = first; it != end; ++it) coverCount[*it]--;
+            inCover[s] = 0;
+            dropped.push_back(s);
         }
+    };
+
+    vector<int> candidates = chosen;
+    dropRedundant(candidates);
+
+    // Element -> subsets index, to find the chosen subsets a swap touches
+    vector<int> elementOffsets(instance.elementCount + 1, 0);
+    for (int e : instance.members) elementOffsets[e + 1]++;
+    partial_sum(elementOffsets.begin(), elementOffsets.end(), elementOffsets.begin());
+    vector<int> elementSubsets(instance.members.size());
+    vector<int> fill(elementOffsets.begin(), elementOffsets.end() - 1);
+    for (int s = 0; s < subsetCount; s++) {
+        for (auto [it, end] = membersOf(s); it != end; ++it) elementSubsets[fill[*it]++] = s;
     }
-    
-    return result;
-}
 
-// Function to approximate Vertex Cover using greedy algorithm (matching-based)
-set<int> approximateVertexCover(map<int, vector<int>>& graph) {
-    set<int> cover;
-    vector<pair<int, int>> edges;
-    
-    // Create a list of all edges (assuming undirected graph)
-    for (auto& node : graph) {
-        int u = node.first;
-        for (int v : node.second) {
-            if (u < v) { // Avoid duplicate edges and self-loops
-                edges.push_back({u, v});
+    // seen[s] == stamp: s is already a candidate for the current try. Each try
+    // takes a fresh stamp, since the same t is tried again in later passes
+    vector<unsigned> seen(subsetCount, 0);
+    unsigned stamp = 0;
+    bool improved = true;
+    bool outOfTime = false;
+    while (improved && !outOfTime) {
+        improved = false;
+        for (int t = 0; t < subsetCount; t++) {
+            if ((t & 255) == 0 && chrono::steady_clock::now() > deadline) {
+                outOfTime = true;
+                break;
+            }
+            if (inCover[t]) continue;
+
+            if (++stamp == 0) {
+                seen.assign(subsetCount, 0);
+                stamp = 1;
+            }
+            candidates.clear();
+            for (auto [it, end] = membersOf(t); it != end; ++it) {
+                coverCount[*it]++;
+                for (int k = elementOffsets[*it]; k < elementOffsets[*it + 1]; k++) {
+                    int s = elementSubsets[k];
+                    if (inCover[s] && seen[s] != stamp) {
+                        seen[s] = stamp;
+                        candidates.push_back(s);
+                    }
+                }
             }
+            dropRedundant(candidates);
+
+            double droppedCost = 0;
+            for (int s : dropped) droppedCost += costOf(s);
+            if (droppedCost > costOf(t) + EPS) {
+                inCover[t] = 1;
+                improved = true;
+                continue;
+            }
+
+            // Not worth it: undo
+            for (int s : dropped) {
+                inCover[s] = 1;
+                for (auto [it, end] = membersOf(s); it != end; ++it) coverCount[*it]++;
+            }
+            for (auto [it, end] = membersOf(t); it != end; ++it) coverCount[*it]--;
         }
     }
-    
-    // Greedy approach: repeatedly pick edges and add both endpoints
-    while (!edges.empty()) {
-        // Pick an arbitrary edge (the first one)
-        auto edge = edges[0];
-        int u = edge.first;
-        int v = edge.second;
-        
-        // Add both endpoints to cover
-        cover.insert(u);
-        cover.insert(v);
-        
-        // Remove all edges incident to u or v. 
-        // Note: C++11 and later allows in-place removal like this:
-        edges.erase(remove_if(edges.begin(), edges.end(), 
-                                [u, v](const pair<int, int>& e) {
-                                    return e.first == u || e.second == u || 
-                                           e.first == v || e.second == v;
-                                }), edges.end());
+
+    chosen.clear();
+    for (int s = 0; s < subsetCount; s++) {
+        if (inCover[s]) chosen.push_back(s);
     }
-    
-    return cover;
 }
 
-// Function to print a set
-void printSet(const set<int>& s, const string& name) {
-    cout << name << ": {";
-    bool first = true;
-    for (int element : s) {
-        if (!first) cout << ", ";
-        cout << element;
-        first = false;
+// Parse one 'node: neighbor1, neighbor2, ...' line in [p, end)
+// Returns false if the line is malformed
+bool parseAdjacencyLine(const char* p, const char* end, int& node, vector<int>& neighbors) {
+    auto skipSpace = [&]() { while (p < end && isspace((unsigned char)*p)) p++; };
+
+    neighbors.clear();
+    skipSpace();
+    auto res = from_chars(p, end, node);
+    if (res.ec != errc()) return false;
+    p = res.ptr;
+    skipSpace();
+    if (p == end || *p != ':') return false;
+    p++;
+
+    skipSpace();
+    while (p < end) {
+        int neighbor;
+        res = from_chars(p, end, neighbor);
+        if (res.ec != errc()) return false;
+        neighbors.push_back(neighbor);
+        p = res.ptr;
+        skipSpace();
+        if (p == end) break;
+        if (*p != ',') return false;
+        p++;
+        skipSpace();
     }
-    cout << "}" << endl;
+    return true;
 }
 
-// 🆕 New function to parse graph input from a file
-map<int, vector<int>> parseGraphFromFile(const string& filename) {
-    map<int, vector<int>> graph;
+// Vertex Cover straight from the file, one line at a time, without building the
+// graph. Edges are taken in file order, so the cover matches
+// approximateVertexCover when the lines are sorted by node id
+set<int> streamVertexCover(const string& filename) {
+    set<int> cover;
     ifstream file(filename);
     string line;
 
     if (!file.is_open()) {
         cerr << "Error: Could not open file '" << filename << "'" << endl;
-        return graph;
+        return cover;
     }
 
+    unordered_set<int> covered;
+    vector<int> neighbors;
     while (getline(file, line)) {
-        if (line.empty() || line[0] == '#') continue; // Skip empty lines and comments
-        
-        size_t colonPos = line.find(':');
-        if (colonPos == string::npos) {
+        if (line.empty() || line[0] == '#') continue;
+
+        int u;
+        if (!parseAdjacencyLine(line.data(), line.data() + line.size(), u, neighbors)) {
             cerr << "Warning: Skipping line with invalid format: " << line << endl;
             continue;
         }
-        
-        try {
-            int node = stoi(line.substr(0, colonPos));
-            string neighborsStr = line.substr(colonPos + 1);
-            
-            // Parse neighbors
-            vector<int> neighbors;
-            stringstream ss(neighborsStr);
-            string neighbor;
-            
-            while (getline(ss, neighbor, ',')) {
-                // Remove whitespace
-                neighbor.erase(remove_if(neighbor.begin(), neighbor.end(), ::isspace), neighbor.end());
-                if (!neighbor.empty()) {
-                    neighbors.push_back(stoi(neighbor));
-                }
+        for (int v : neighbors) {
+            if (u >= v) continue;
+            if (covered.count(u)) break;
+            if (!covered.insert(v).second) continue;
+            covered.insert(u);
+        }
+    }
+
+    cover.insert(covered.begin(), covered.end());
+    return cover;
+}
+
+// Undirected graph in CSR form. Node ids are compacted to 0..n-1 in ascending
+// order (ids[i] is the original id) and the neighbours of node i, as listed on
+// its input line, are adj[offsets[i] .. offsets[i + 1])
+struct CSRGraph {
+    vector<int> ids;
+    vector<int> offsets{0};
+    vector<int> adj;
+    vector<char> listed; // Node had its own 'node: ...' line
+
+    int nodeCount() const { return (int)ids.size(); }
+};
+
+// Build the CSR from parsed lines: line l is node lineNode[l] with raw
+// neighbours rawNeighbors[lineStart[l] .. lineStart[l + 1]). A node listed
+// twice keeps its last line, like assigning into the map did
+CSRGraph buildCSRGraph(const vector<int>& lineNode, const vector<size_t>& lineStart,
+                       const vector<int>& rawNeighbors) {
+    CSRGraph graph;
+    if (lineNode.empty()) return graph;
+
+    // Drop lines that a later line for the same node overrides
+    size_t lines = lineNode.size();
+    vector<int> order(lines);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return lineNode[a] < lineNode[b]; });
+    vector<char> keep(lines, 0);
+    for (size_t k = 0; k < lines; k++) {
+        keep[order[k]] = k + 1 == lines || lineNode[order[k + 1]] != lineNode[order[k]];
+    }
+    auto forEachId = [&](auto&& visit) {
+        for (size_t l = 0; l < lines; l++) {
+            if (!keep[l]) continue;
+            visit(lineNode[l]);
+            for (size_t k = lineStart[l]; k < lineStart[l + 1]; k++) visit(rawNeighbors[k]);
+        }
+    };
+
+    int lo = lineNode[order[0]], hi = lineNode[order[lines - 1]];
+    size_t total = 0;
+    forEachId([&](int id) { lo = min(lo, id); hi = max(hi, id); total++; });
+
+    // Dense ids (the usual 0..n-1 numbering) compact through a lookup table;
+    // sparse ones fall back to sort + binary search
+    long long range = (long long)hi - lo + 1;
+    vector<int> table;
+    bool dense = range <= 2 * (long long)total + 1024;
+    if (dense) {
+        table.assign(range, -1);
+        forEachId([&](int id) { table[id - lo] = 0; });
+        for (long long k = 0; k < range; k++) {
+            if (table[k] == 0) {
+                table[k] = (int)graph.ids.size();
+                graph.ids.push_back((int)(k + lo));
             }
-            
-            graph[node] = neighbors;
-        } catch (const std::exception& e) {
-            cerr << "Warning: Error parsing line: " << line << " (" << e.what() << ")" << endl;
+        }
+    } else {
+        graph.ids.reserve(total);
+        forEachId([&](int id) { graph.ids.push_back(id); });
+        sort(graph.ids.begin(), graph.ids.end());
+        graph.ids.erase(unique(graph.ids.begin(), graph.ids.end()), graph.ids.end());
+        graph.ids.shrink_to_fit();
+    }
+    auto compact = [&](int id) {
+        if (dense) return table[id - lo];
+        return (int)(lower_bound(graph.ids.begin(), graph.ids.end(), id) - graph.ids.begin());
+    };
+
+    int n = graph.nodeCount();
+    vector<int> lineOf(n, -1);
+    for (size_t l = 0; l < lines; l++) {
+        if (keep[l]) lineOf[compact(lineNode[l])] = (int)l;
+    }
+
+    graph.listed.assign(n, 0);
+    graph.offsets.assign(n + 1, 0);
+    for (int i = 0; i < n; i++) {
+        int l = lineOf[i];
+        graph.listed[i] = l >= 0;
+        graph.offsets[i + 1] = graph.offsets[i] + (l >= 0 ? (int)(lineStart[l + 1] - lineStart[l]) : 0);
+    }
+    graph.adj.resize(graph.offsets[n]);
+    for (int i = 0; i < n; i++) {
+        if (lineOf[i] < 0) continue;
+        int* out = graph.adj.data() + graph.offsets[i];
+        for (size_t k = lineStart[lineOf[i]]; k < lineStart[lineOf[i] + 1]; k++) {
+            *out++ = compact(rawNeighbors[k]);
         }
     }
-    
     return graph;
 }
 
-// Function to create subsets for set cover from graph
-void createSubsetsFromGraph(const map<int, vector<int>>& graph, 
-                            vector<set<int>>& subsets, set<int>& universe) {
-    subsets.clear();
-    universe.clear();
-
-    // The universe is all unique node IDs in the graph
-    for (const auto& node : graph) {
-        universe.insert(node.first);
-        for (int neighbor : node.second) {
-            universe.insert(neighbor);
+CSRGraph buildCSRGraph(const map<int, vector<int>>& adjacency) {
+    vector<int> lineNode;
+    vector<size_t> lineStart{0};
+    vector<int> rawNeighbors;
+    for (const auto& node : adjacency) {
+        lineNode.push_back(node.first);
+        rawNeighbors.insert(rawNeighbors.end(), node.second.begin(), node.second.end());
+        lineStart.push_back(rawNeighbors.size());
+    }
+    return buildCSRGraph(lineNode, lineStart, rawNeighbors);
+}
+
+// Load a 'node: neighbor1, neighbor2, ...' file in a single pass over the
+// mapped buffer
+bool loadGraphFile(const string& filename, CSRGraph& graph) {
+    MappedFile file;
+    if (!file.open(filename, false)) {
+        cerr << "Error: Could not open file '" << filename << "'" << endl;
+        return false;
+    }
+
+    vector<int> lineNode;
+    vector<size_t> lineStart{0};
+    vector<int> rawNeighbors;
+    vector<int> neighbors;
+    rawNeighbors.reserve(file.size() / 4);
+
+    const char* p = file.data();
+    const char* end = p + file.size();
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (eol == nullptr) eol = end;
+        const char* line = p;
+        p = eol + 1;
+
+        const char* first = line;
+        while (first < eol && isspace((unsigned char)*first)) first++;
+        if (first == eol || *line == '#') continue; // Skip empty lines and comments
+
+        int node;
+        if (!parseAdjacencyLine(line, eol, node, neighbors)) {
+            string text(line, eol);
+            if (!text.empty() && text.back() == '\r') text.pop_back();
+            cerr << "Warning: Skipping line with invalid format: " << text << endl;
+            continue;
         }
+        lineNode.push_back(node);
+        rawNeighbors.insert(rawNeighbors.end(), neighbors.begin(), neighbors.end());
+        lineStart.push_back(rawNeighbors.size());
     }
-    
-    // Each subset S_i is defined as the node i and its neighbors (A[i] union {i})
-    for (const auto& node : graph) {
-        set<int> subset;
-        subset.insert(node.first);
-        for (int neighbor : node.second) {
-            subset.insert(neighbor);
+
+    graph = buildCSRGraph(lineNode, lineStart, rawNeighbors);
+    return true;
+}
+
+// Matching-based Vertex Cover on the CSR. Walking the edges once and taking
+// every edge whose endpoints are both still uncovered builds a maximal
+// matching, which is the same 2-approximation as repeatedly taking the first
+// remaining edge - and picks the same edges. Returns the original node ids,
+// ascending
+vector<int> approximateVertexCover(const CSRGraph& graph) {
+    int n = graph.nodeCount();
+    vector<uint64_t> covered((n + 63) / 64, 0);
+    auto isCovered = [&](int i) { return (covered[i >> 6] >> (i & 63)) & 1; };
+
+    // Compaction keeps id order, so u < v compares compact indices directly
+    for (int u = 0; u < n; u++) {
+        for (int k = graph.offsets[u]; k < graph.offsets[u + 1]; k++) {
+            int v = graph.adj[k];
+            if (u >= v) continue;
+            if (isCovered(u)) break;
+            if (isCovered(v)) continue;
+            covered[u >> 6] |= 1ULL << (u & 63);
+            covered[v >> 6] |= 1ULL << (v & 63);
         }
-        subsets.push_back(subset);
     }
+
+    vector<int> cover;
+    for (int u = 0; u < n; u++) {
+        if (isCovered(u)) cover.push_back(graph.ids[u]);
+    }
+    return cover;
+}
+
+// Function to print a set
+template <typename Container>
+void printSet(const Container& s, const string& name) {
+    cout << name << ": {";
+    bool first = true;
+    for (int element : s) {
+        if (!first) cout << ", ";
+        cout << element;
+        first = false;
+    }
+    cout << "}" << endl;
+}
+
+// Neighbourhood subsets straight from the CSR: one subset per listed node,
+// {node} plus its neighbours, with nodes doubling as the compacted elements.
+// subsetNodes[i] is the compact node behind subset i
+SetCoverInstance createSubsetsFromGraph(const CSRGraph& graph, vector<int>& subsetNodes) {
+    SetCoverInstance instance;
+    instance.elementCount = graph.nodeCount();
+    subsetNodes.clear();
+
+    for (int u = 0; u < graph.nodeCount(); u++) {
+        if (!graph.listed[u]) continue;
+        subsetNodes.push_back(u);
+
+        size_t begin = instance.members.size();
+        instance.members.push_back(u);
+        instance.members.insert(instance.members.end(), graph.adj.begin() + graph.offsets[u],
+                                graph.adj.begin() + graph.offsets[u + 1]);
+        sort(instance.members.begin() + begin, instance.members.end());
+        instance.members.erase(unique(instance.members.begin() + begin, instance.members.end()),
+                               instance.members.end());
+        instance.offsets.push_back((int)instance.members.size());
+    }
+    return instance;
+}
+
+// Subset costs from a 'node: cost' file; nodes that are not listed cost 1.
+// costs[i] belongs to subset i, i.e. to node subsetNodes[i]
+bool loadSubsetCosts(const string& filename, const CSRGraph& graph, const vector<int>& subsetNodes,
+                     vector<double>& costs) {
+    MappedFile file;
+    if (!file.open(filename, false)) {
+        cerr << "Error: Could not open file '" << filename << "'" << endl;
+        return false;
+    }
+
+    costs.assign(subsetNodes.size(), 1.0);
+    long long unknown = 0;
+    const char* p = file.data();
+    const char* end = p + file.size();
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (eol == nullptr) eol = end;
+        const char* q = p;
+        const char* line = p;
+        p = eol + 1;
+
+        while (q < eol && isspace((unsigned char)*q)) q++;
+        if (q == eol || *q == '#') continue;
+
+        int node = 0;
+        double cost = 0;
+        auto a = from_chars(q, eol, node);
+        q = a.ptr;
+        while (q < eol && isspace((unsigned char)*q)) q++;
+        bool ok = a.ec == errc() && q < eol && *q == ':';
+        if (ok) {
+            q++;
+            while (q < eol && isspace((unsigned char)*q)) q++;
+            auto b = from_chars(q, eol, cost);
+            ok = b.ec == errc() && cost >= 0;
+            q = b.ptr;
+            while (q < eol && isspace((unsigned char)*q)) q++;
+            ok = ok && q == eol;
+        }
+        if (!ok) {
+            string text(line, eol);
+            if (!text.empty() && text.back() == '\r') text.pop_back();
+            cerr << "Warning: Skipping line with invalid format: " << text << endl;
+            continue;
+        }
+
+        // Subsets follow the listed nodes in id order
+        auto id = lower_bound(graph.ids.begin(), graph.ids.end(), node);
+        int u = (int)(id - graph.ids.begin());
+        auto at = lower_bound(subsetNodes.begin(), subsetNodes.end(), u);
+        if (id == graph.ids.end() || *id != node || at == subsetNodes.end() || *at != u) {
+            unknown++;
+            continue;
+        }
+        costs[at - subsetNodes.begin()] = cost;
+    }
+    if (unknown > 0) {
+        cerr << "Warning: Ignored costs for " << unknown << " nodes that have no subset" << endl;
+    }
+    return true;
 }
 
 int main() {
@@ -171,17 +679,19 @@ int main() {
     cout << "1. Use predefined sample graph" << endl;
     cout << "2. Enter graph manually (console)" << endl;
     cout << "**3. Load graph from text file**" << endl;
-    cout << "Enter choice (1, 2, or 3): ";
+    cout << "4. Vertex cover only, streamed from a text file too large to load" << endl;
+    cout << "Enter choice (1, 2, 3, or 4): ";
     
     int choice;
     cin >> choice;
     cin.ignore(); // Clear newline character
     
-    map<int, vector<int>> graph;
+    map<int, vector<int>> adjacency;
+    CSRGraph graph;
     
     if (choice == 1) {
         // Predefined Sample graph
-        graph = {
+        adjacency = {
             {0, {1, 2, 3, 4}},
             {1, {0, 2, 5, 6}},
             {2, {0, 1, 3, 7}},
@@ -193,6 +703,7 @@ int main() {
             {8, {3, 5, 7, 9}},
             {9, {4, 6, 8}}
         };
+        graph = buildCSRGraph(adjacency);
         cout << "Using predefined sample graph." << endl;
     } else if (choice == 2) {
         // Manual Input (using the existing parsing logic)
@@ -221,68 +732,100 @@ int main() {
                         neighbors.push_back(stoi(neighbor));
                     }
                 }
-                graph[node] = neighbors;
+                adjacency[node] = neighbors;
             } catch (const std::exception& e) {
                 cerr << "Warning: Error parsing input line. (" << e.what() << ")" << endl;
             }
         }
+        graph = buildCSRGraph(adjacency);
     } else if (choice == 3) {
         // 🆕 File Input
         string filename;
         cout << "Enter graph filename (e.g., graph.txt): ";
         getline(cin, filename);
-        graph = parseGraphFromFile(filename);
-        if (graph.empty()) {
+        if (!loadGraphFile(filename, graph) || graph.nodeCount() == 0) {
             cout << "Failed to load graph or graph is empty." << endl;
             return 1;
         }
         cout << "Graph loaded from file." << endl;
+    } else if (choice == 4) {
+        // The graph is never held in memory, so there is no set cover here
+        string filename;
+        cout << "Enter graph filename (e.g., graph.txt): ";
+        getline(cin, filename);
+        set<int> vertexCover = streamVertexCover(filename);
+        cout << "\n=== Vertex Cover Problem (Approximation, streamed) ===" << endl;
+        cout << "Approximate Vertex Cover Size: " << vertexCover.size() << endl;
+        printSet(vertexCover, "Vertex Cover");
+        return 0;
     } else {
         cout << "Invalid choice. Exiting." << endl;
         return 1;
     }
     
-    // Print the graph
+    // Print the graph (only the first nodes of a large one)
+    const int shownNodes = 50;
     cout << "\nGraph (Adjacency List):" << endl;
-    for (const auto& node : graph) {
-        cout << node.first << ": [";
-        for (size_t i = 0; i < node.second.size(); i++) {
-            cout << node.second[i];
-            if (i < node.second.size() - 1) cout << ", ";
+    int printed = 0;
+    for (int u = 0; u < graph.nodeCount() && printed < shownNodes; u++) {
+        if (!graph.listed[u]) continue;
+        printed++;
+        cout << graph.ids[u] << ": [";
+        for (int k = graph.offsets[u]; k < graph.offsets[u + 1]; k++) {
+            cout << graph.ids[graph.adj[k]];
+            if (k < graph.offsets[u + 1] - 1) cout << ", ";
         }
         cout << "]" << endl;
     }
+    int listedNodes = (int)count(graph.listed.begin(), graph.listed.end(), 1);
+    if (listedNodes > printed) {
+        cout << "... (" << listedNodes - printed << " more nodes)" << endl;
+    }
     
     // Solve Vertex Cover Problem
     cout << "\n=== Vertex Cover Problem (Approximation) ===" << endl;
-    set<int> vertexCover = approximateVertexCover(graph);
+    vector<int> vertexCover = approximateVertexCover(graph);
     cout << "Approximate Vertex Cover Size: " << vertexCover.size() << endl;
     printSet(vertexCover, "Vertex Cover");
     
     // Solve Set Cover Problem
     cout << "\n=== Set Cover Problem (Approximation) ===" << endl;
-    vector<set<int>> subsets;
-    set<int> universe;
-    createSubsetsFromGraph(graph, subsets, universe);
+    vector<int> subsetNodes;
+    SetCoverInstance subsets = createSubsetsFromGraph(graph, subsetNodes);
+    
+    cout << "Universe size: " << subsets.elementCount << endl;
+    cout << "Number of subsets: " << subsets.subsetCount() << endl;
+    
+    string weightsFile;
+    cout << "Enter subset weights filename ('node: cost' per line, empty for unit costs): ";
+    getline(cin, weightsFile);
+    vector<double> costs;
+    if (!weightsFile.empty() && !loadSubsetCosts(weightsFile, graph, subsetNodes, costs)) {
+        cout << "Using unit costs." << endl;
+        costs.clear();
+    }
     
-    cout << "Universe size: " << universe.size() << endl;
-    cout << "Number of subsets: " << subsets.size() << endl;
+    const char* kernel;
+    vector<int> setCover = lazyGreedySetCover(subsets, costs, &kernel);
+    cout << "Gain kernel: " << kernel << endl;
+    cout << "Greedy Set Cover Size: " << setCover.size() << " (cost " << coverCost(setCover, costs) << ")" << endl;
     
-    set<int> setCover = approximateSetCover(subsets, universe);
+    const double refineSeconds = 1.0;
+    refineSetCover(subsets, costs, setCover, refineSeconds);
     cout << "Approximate Set Cover Size: " << setCover.size() << endl;
+    cout << "Total Cost: " << coverCost(setCover, costs) << endl;
     printSet(setCover, "Set Cover (subset indices)");
     
     // Print the actual subsets used
     cout << "\nSubsets used in Set Cover:" << endl;
     for (int subsetIndex : setCover) {
-        // Since we created subsets directly from the map iteration, 
-        // the subsetIndex corresponds to the node ID if the map keys are 0, 1, 2...
-        // For general graph, it is just the index of the subset vector.
-        cout << "Subset " << subsetIndex << " (Node " << subsetIndex << " and neighbors): {";
+        // Subsets follow the listed nodes in id order, so the index is the
+        // node ID when the nodes are numbered 0, 1, 2...
+        cout << "Subset " << subsetIndex << " (Node " << graph.ids[subsetNodes[subsetIndex]] << " and neighbors): {";
         bool first = true;
-        for (int element : subsets[subsetIndex]) {
+        for (int k = subsets.offsets[subsetIndex]; k < subsets.offsets[subsetIndex + 1]; k++) {
             if (!first) cout << ", ";
-            cout << element;
+            cout << graph.ids[subsets.members[k]];
             first = false;
         }
         cout << "}" << endl;
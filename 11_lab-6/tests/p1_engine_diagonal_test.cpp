@@ -0,0 +1,89 @@
+// Floyd-Warshall and Johnson must agree on the diagonal: self-loops, INF
+// diagonals and cycles back to the source.
+//
+// Build and run from 11_lab-6:
+//   g++ -std=c++17 -O2 -pthread tests/p1_engine_diagonal_test.cpp -o p1_engine_diagonal_test
+//   ./p1_engine_diagonal_test
+
+#define P1_NO_MAIN
+#include "../p1.cpp"
+
+static int failures = 0;
+
+static void check(bool condition, const string& what) {
+    if (!condition) {
+        cout << "FAIL: " << what << endl;
+        failures++;
+    }
+}
+
+static DistMatrix makeGraph(const vector<vector<long long>>& rows) {
+    DistMatrix graph((int)rows.size(), INF);
+    for (size_t i = 0; i < rows.size(); i++) {
+        for (size_t j = 0; j < rows.size(); j++) {
+            graph[(int)i][(int)j] = rows[i][j];
+        }
+    }
+    return graph;
+}
+
+// Runs one engine; returns false on a negative cycle.
+static bool solve(const DistMatrix& graph, Engine engine, vector<vector<long long>>& dist) {
+    int n = graph.size();
+    FloydWarshall fw(n);
+    fw.setGraph(graph);
+    fw.setEngine(engine);
+    if (!fw.computeShortestPaths()) return false;
+    dist.assign(n, vector<long long>(n));
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            dist[i][j] = fw.getDistance(i, j);
+        }
+    }
+    return true;
+}
+
+static void expectSame(const string& name, const vector<vector<long long>>& rows,
+                       const vector<pair<int, long long>>& diagonal) {
+    DistMatrix graph = makeGraph(rows);
+    vector<vector<long long>> fwDist, johnsonDist;
+    bool fwOk = solve(graph, ENGINE_FLOYD_WARSHALL, fwDist);
+    bool johnsonOk = solve(graph, ENGINE_JOHNSON, johnsonDist);
+    check(fwOk && johnsonOk, name + ": unexpected negative cycle");
+    check(fwDist == johnsonDist, name + ": engines disagree");
+    for (const auto& entry : diagonal) {
+        if (fwOk) {
+            check(fwDist[entry.first][entry.first] == entry.second,
+                  name + ": dist[" + to_string(entry.first) + "][" + to_string(entry.first) + "]");
+        }
+    }
+}
+
+int main() {
+    // Negative self-loop: a negative cycle for both engines
+    {
+        DistMatrix graph = makeGraph({{0, 4, INF}, {INF, -1, 2}, {INF, INF, 0}});
+        vector<vector<long long>> dist;
+        check(!solve(graph, ENGINE_FLOYD_WARSHALL, dist), "negative self-loop: Floyd-Warshall");
+        check(!solve(graph, ENGINE_JOHNSON, dist), "negative self-loop: Johnson");
+    }
+
+    // INF diagonal: a vertex on a cycle gets the cycle length, one that is not
+    // stays unreachable from itself
+    expectSame("INF diagonal", {{INF, 2, INF}, {3, INF, 1}, {INF, INF, INF}},
+               {{0, 5}, {1, 5}, {2, UNREACHABLE}});
+
+    // Positive self-loop, undercut by a shorter cycle on vertex 0 only
+    expectSame("positive self-loop", {{9, 1, INF}, {2, 7, INF}, {INF, 1, 4}},
+               {{0, 3}, {1, 3}, {2, 4}});
+
+    // Zero diagonal with negative edges (no negative cycle)
+    expectSame("zero diagonal", {{0, -2, INF}, {INF, 0, 3}, {1, INF, 0}},
+               {{0, 0}, {1, 0}, {2, 0}});
+
+    if (failures == 0) {
+        cout << "All engine diagonal tests passed." << endl;
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,176 @@
+// Every way of running Floyd-Warshall must give the textbook answer: the
+// classic loop and the blocked kernel at several tile sizes, serial and
+// threaded, Johnson, and each min-plus row kernel the CPU supports. Next hops
+// must spell out a path of exactly the reported length, also with zero-weight
+// cycles in the graph.
+//
+// Build and run from 11_lab-6:
+//   g++ -std=c++17 -O2 -pthread tests/p1_kernel_agreement_test.cpp -o p1_kernel_agreement_test
+//   ./p1_kernel_agreement_test
+
+#define P1_NO_MAIN
+#include "../p1.cpp"
+
+#include <random>
+
+static int failures = 0;
+
+static void check(bool condition, const string& what) {
+    if (!condition) {
+        cout << "FAIL: " << what << endl;
+        failures++;
+    }
+}
+
+// Random graph without negative cycles: w(u, v) = base + p[u] - p[v] with
+// base >= 0, so every cycle weighs its non-negative base sum. base is often 0,
+// which gives zero-weight cycles.
+static DistMatrix randomGraph(mt19937& rng, int n, double density) {
+    vector<long long> potential(n);
+    for (long long& p : potential) p = (long long)(rng() % 21);
+    DistMatrix graph(n, INF);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            if (i != j && rng() % 1000 < density * 1000) {
+                long long base = (rng() % 3 == 0) ? 0 : (long long)(rng() % 30);
+                graph[i][j] = base + potential[i] - potential[j];
+            } else if (i == j && rng() % 4 == 0) {
+                graph[i][j] = (long long)(rng() % 10);
+            }
+        }
+    }
+    return graph;
+}
+
+// Plain k-i-j Floyd-Warshall on the diagonal convention of p1: dist[i][i] is
+// the self-loop weight or a shorter cycle through i.
+static vector<vector<long long>> reference(const DistMatrix& graph) {
+    int n = graph.size();
+    vector<vector<long long>> d(n, vector<long long>(n));
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            d[i][j] = (graph[i][j] == INF) ? UNREACHABLE : graph[i][j];
+        }
+    }
+    for (int k = 0; k < n; k++) {
+        for (int i = 0; i < n; i++) {
+            if (d[i][k] == UNREACHABLE) continue;
+            for (int j = 0; j < n; j++) {
+                if (d[k][j] != UNREACHABLE && d[i][k] + d[k][j] < d[i][j]) {
+                    d[i][j] = d[i][k] + d[k][j];
+                }
+            }
+        }
+    }
+    return d;
+}
+
+static void expectAgreement(const string& name, const DistMatrix& graph, Engine engine, int tile,
+                            int threads) {
+    int n = graph.size();
+    vector<vector<long long>> expected = reference(graph);
+    FloydWarshall fw(n);
+    fw.setGraph(graph);
+    fw.setEngine(engine);
+    fw.setTileSize(tile);
+    fw.setThreadCount(threads);
+    if (!fw.computeShortestPaths()) {
+        check(false, name + ": unexpected negative cycle");
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            string at = name + ": (" + to_string(i) + ", " + to_string(j) + ")";
+            if (fw.getDistance(i, j) != expected[i][j]) {
+                check(false, at + " distance");
+                return;
+            }
+            if (i == j || expected[i][j] == UNREACHABLE) continue;
+
+            long long length = 0;
+            int current = i, hops = 0;
+            while (current != j && current != -1 && hops < n) {
+                int hop = fw.getNextHop(current, j);
+                if (hop != -1) length += graph[current][hop];
+                current = hop;
+                hops++;
+            }
+            if (current != j || length != expected[i][j]) {
+                check(false, at + " path");
+                return;
+            }
+        }
+    }
+}
+
+// Each row kernel against the scalar one on random rows and ranges
+static void expectKernelsAgree(mt19937& rng) {
+    vector<pair<string, RelaxRowFn>> kernels;
+#ifdef FW_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.push_back(make_pair(string("AVX2"), relaxRowAVX2));
+    }
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")) {
+        kernels.push_back(make_pair(string("AVX-512"), relaxRowAVX512));
+    }
+#endif
+    auto randomValue = [&]() {
+        return (rng() % 5 == 0) ? UNREACHABLE : (long long)(rng() % 200) - 50;
+    };
+    for (const auto& kernel : kernels) {
+        for (int trial = 0; trial < 2000; trial++) {
+            int len = 1 + rng() % 70;
+            vector<long long> di(len), dk(len);
+            vector<int> ni(len);
+            for (int j = 0; j < len; j++) {
+                di[j] = randomValue();
+                dk[j] = randomValue();
+                ni[j] = (int)(rng() % len);
+            }
+            long long dik = (long long)(rng() % 100) - 20;
+            int nik = (int)(rng() % len);
+            int j0 = rng() % len, j1 = j0 + rng() % (len - j0 + 1);
+
+            vector<long long> expectDist = di, gotDist = di;
+            vector<int> expectNext = ni, gotNext = ni;
+            relaxRowScalar(expectDist.data(), dk.data(), expectNext.data(), dik, nik, j0, j1);
+            kernel.second(gotDist.data(), dk.data(), gotNext.data(), dik, nik, j0, j1);
+            if (gotDist != expectDist || gotNext != expectNext) {
+                check(false, kernel.first + " kernel differs from scalar");
+                break;
+            }
+        }
+    }
+}
+
+int main() {
+    mt19937 rng(2024);
+    expectKernelsAgree(rng);
+
+    const int tiles[] = {0, 1, 3, 8, 16, 64};
+    const int threadCounts[] = {1, 3, 4};
+    for (int trial = 0; trial < 40; trial++) {
+        int n = 1 + rng() % 45;
+        double density = (trial % 3 == 0) ? 0.08 : 0.4;
+        DistMatrix graph = randomGraph(rng, n, density);
+        string graphName = "graph " + to_string(trial) + " (n = " + to_string(n) + ")";
+        for (int tile : tiles) {
+            for (int threads : threadCounts) {
+                expectAgreement(graphName + ", tile " + to_string(tile) + ", " + to_string(threads) + " threads",
+                                graph, ENGINE_FLOYD_WARSHALL, tile, threads);
+            }
+        }
+        for (int threads : threadCounts) {
+            expectAgreement(graphName + ", Johnson, " + to_string(threads) + " threads", graph,
+                            ENGINE_JOHNSON, 0, threads);
+        }
+    }
+
+    if (failures == 0) {
+        cout << "All kernel agreement tests passed." << endl;
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,154 @@
+// Matrix files: a text matrix, its int32 and int64 binary forms and the
+// zero-copy mapping p1 uses for int64 files must all give the same graph and
+// the same shortest paths; damaged headers must be rejected.
+//
+// Build and run from 11_lab-6:
+//   g++ -std=c++17 -O2 -pthread tests/p1_matrix_file_test.cpp -o p1_matrix_file_test
+//   ./p1_matrix_file_test
+
+#define P1_NO_MAIN
+#include "../p1.cpp"
+
+static int failures = 0;
+
+static void check(bool condition, const string& what) {
+    if (!condition) {
+        cout << "FAIL: " << what << endl;
+        failures++;
+    }
+}
+
+static vector<long long> solve(FloydWarshall& fw, int n) {
+    vector<long long> all;
+    fw.setEngine(ENGINE_FLOYD_WARSHALL);
+    if (!fw.computeShortestPaths()) return all;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            all.push_back(fw.getDistance(i, j));
+        }
+    }
+    return all;
+}
+
+static vector<char> readFile(const string& path) {
+    ifstream in(path, ios::binary);
+    return vector<char>(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+static void writeFile(const string& path, const vector<char>& bytes) {
+    ofstream out(path, ios::binary);
+    out.write(bytes.data(), bytes.size());
+}
+
+// Write `rows` as a binary matrix, INF becoming `noEdge`
+static bool writeRows(const string& path, const vector<vector<long long>>& rows, MatrixDType dtype,
+                      int64_t noEdge, string& error) {
+    return writeMatrixFile(path, (int)rows.size(), dtype, noEdge, [&](int i, int64_t* out) {
+        for (size_t j = 0; j < rows.size(); j++) {
+            out[j] = (rows[i][j] == INF) ? noEdge : rows[i][j];
+        }
+        return true;
+    }, error);
+}
+
+int main() {
+    const string textPath = "p1_matrix_file_test.txt";
+    const string narrowPath = "p1_matrix_file_test32.mat";
+    const string widePath = "p1_matrix_file_test64.mat";
+    const string badPath = "p1_matrix_file_test_bad.mat";
+
+    // Text input with INF, negative weights, a leading plus and a UTF-8
+    // non-breaking space between two numbers
+    {
+        ofstream text(textPath);
+        text << "5\n"
+             << "0 4 " << INF << " 5 " << INF << "\n"
+             << INF << " 0 1 " << INF << " 6\n"
+             << "2 " << INF << " 0 3 " << INF << "\n"
+             << INF << " 1 +2 0 -1\n"
+             << "1\xC2\xA0" << INF << " " << INF << " " << INF << " 0\n";
+    }
+
+    TextMatrixReader reader;
+    check(reader.open(textPath), "text matrix opens");
+    int n = reader.vertices();
+    DistMatrix graph(n, INF);
+    check(reader.readRows<long long>([&](int i) { return graph.rowData(i); }),
+          "text matrix parses: " + reader.message("vertices"));
+    vector<vector<long long>> rows(n, vector<long long>(n));
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            rows[i][j] = graph[i][j];
+        }
+    }
+    check(rows[3][2] == 2 && rows[4][0] == 1 && rows[4][1] == INF, "text values read as written");
+
+    FloydWarshall fromText(n);
+    fromText.setGraph(graph);
+    vector<long long> expected = solve(fromText, n);
+    check(!expected.empty(), "text graph has no negative cycle");
+
+    string error;
+
+    // int32 file with INF as its no-edge value, read back into rows
+    check(writeRows(narrowPath, rows, MATRIX_INT32, INF, error), "write int32: " + error);
+    vector<vector<long long>> narrowRows;
+    check(loadMatrixFileRows<long long>(narrowPath, narrowRows, (long long)INF, error), "read int32: " + error);
+    check(narrowRows == rows, "int32 file round trip");
+
+    // int64 file in p1's own encoding, used in place through two private mappings
+    check(writeRows(widePath, rows, MATRIX_INT64, UNREACHABLE, error), "write int64: " + error);
+    vector<char> wideBytes = readFile(widePath);
+    {
+        MappedFile weightMap, distMap;
+        MatrixFileHeader header;
+        check(openMatrixFile(widePath, true, weightMap, header, error) &&
+              openMatrixFile(widePath, true, distMap, header, error), "map int64: " + error);
+        FloydWarshall mapped(adoptMappedMatrix(weightMap, header), adoptMappedMatrix(distMap, header));
+        check(solve(mapped, n) == expected, "zero-copy int64 graph gives the text graph's paths");
+    }
+    check(readFile(widePath) == wideBytes, "running on a private mapping leaves the file unchanged");
+
+    // Damaged headers: a row stride whose size wraps around, a data offset
+    // inside the header, and a file cut short
+    MatrixFileHeader header;
+    memcpy(&header, wideBytes.data(), sizeof(header));
+    {
+        vector<char> bytes = wideBytes;
+        MatrixFileHeader bad = header;
+        bad.rowStride = (uint64_t)1 << 61;
+        memcpy(bytes.data(), &bad, sizeof(bad));
+        writeFile(badPath, bytes);
+        MappedFile map;
+        MatrixFileHeader read;
+        check(!openMatrixFile(badPath, false, map, read, error), "wrapping row stride is rejected");
+    }
+    {
+        vector<char> bytes = wideBytes;
+        MatrixFileHeader bad = header;
+        bad.dataOffset = 0;
+        memcpy(bytes.data(), &bad, sizeof(bad));
+        writeFile(badPath, bytes);
+        MappedFile map;
+        MatrixFileHeader read;
+        check(!openMatrixFile(badPath, false, map, read, error), "data offset inside the header is rejected");
+    }
+    {
+        vector<char> bytes(wideBytes.begin(), wideBytes.end() - 8);
+        writeFile(badPath, bytes);
+        MappedFile map;
+        MatrixFileHeader read;
+        check(!openMatrixFile(badPath, false, map, read, error), "truncated file is rejected");
+    }
+
+    remove(textPath.c_str());
+    remove(narrowPath.c_str());
+    remove(widePath.c_str());
+    remove(badPath.c_str());
+
+    if (failures == 0) {
+        cout << "All matrix file tests passed." << endl;
+        return 0;
+    }
+    return 1;
+}
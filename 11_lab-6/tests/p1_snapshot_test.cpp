@@ -0,0 +1,116 @@
+// Snapshots: a saved result loads back unchanged, and a damaged next matrix is
+// rejected instead of steering path reconstruction out of bounds.
+//
+// Build and run from 11_lab-6:
+//   g++ -std=c++17 -O2 -pthread tests/p1_snapshot_test.cpp -o p1_snapshot_test
+//   ./p1_snapshot_test
+
+#define P1_NO_MAIN
+#include "../p1.cpp"
+
+static int failures = 0;
+
+static void check(bool condition, const string& what) {
+    if (!condition) {
+        cout << "FAIL: " << what << endl;
+        failures++;
+    }
+}
+
+static string allPaths(const FloydWarshall& fw, int n) {
+    vector<int> path;
+    string out;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            fw.formatPath(i, j, path, out);
+        }
+    }
+    return out;
+}
+
+static vector<char> readFile(const string& path) {
+    ifstream in(path, ios::binary);
+    return vector<char>(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+}
+
+static void writeFile(const string& path, const vector<char>& bytes) {
+    ofstream out(path, ios::binary);
+    out.write(bytes.data(), bytes.size());
+}
+
+int main() {
+    const string path = "p1_snapshot_test.apsp";
+    DistMatrix graph = DistMatrix::fromRows({{0, 3, INF, 7},
+                                             {8, 0, 2, INF},
+                                             {5, INF, 0, 1},
+                                             {2, INF, INF, 0}}, INF);
+    int n = graph.size();
+    FloydWarshall fw(n);
+    fw.setGraph(graph);
+    check(fw.computeShortestPaths(), "graph has no negative cycle");
+
+    string error;
+    check(fw.saveSnapshot(path, error), "save: " + error);
+
+    // Round trip: same distances and the same reconstructed paths
+    {
+        DistMatrix dist;
+        NextMatrix next;
+        long long edges;
+        check(loadSnapshot(path, dist, next, edges, error), "load: " + error);
+        check(edges == fw.getEdgeCount(), "edge count survives the round trip");
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                check(dist[i][j] == fw.getDistance(i, j),
+                      "dist[" + to_string(i) + "][" + to_string(j) + "]");
+            }
+        }
+        FloydWarshall loaded(move(dist), move(next), edges);
+        check(allPaths(loaded, n) == allPaths(fw, n), "paths survive the round trip");
+    }
+
+    vector<char> original = readFile(path);
+    SnapshotHeader header;
+    memcpy(&header, original.data(), sizeof(header));
+    check(header.nextWidth == 2, "small graphs store 16-bit next entries");
+
+    // A next hop past the last vertex is rejected on load
+    {
+        vector<char> bytes = original;
+        uint16_t bad = (uint16_t)n;
+        memcpy(bytes.data() + header.nextOffset + sizeof(uint16_t), &bad, sizeof(bad));
+        writeFile(path, bytes);
+        DistMatrix dist;
+        NextMatrix next;
+        long long edges;
+        check(!loadSnapshot(path, dist, next, edges, error), "out-of-range next hop is rejected");
+    }
+
+    // A cycle in next (0 -> 1 -> 0 towards 3) stays in range but must not hang
+    // path reconstruction
+    {
+        vector<char> bytes = original;
+        uint16_t toOne = 1, toZero = 0;
+        size_t rowBytes = header.nextStride * header.nextWidth;
+        memcpy(bytes.data() + header.nextOffset + 3 * sizeof(uint16_t), &toOne, sizeof(toOne));
+        memcpy(bytes.data() + header.nextOffset + rowBytes + 3 * sizeof(uint16_t), &toZero, sizeof(toZero));
+        writeFile(path, bytes);
+        DistMatrix dist;
+        NextMatrix next;
+        long long edges;
+        check(loadSnapshot(path, dist, next, edges, error), "in-range cycle still loads: " + error);
+        FloydWarshall loaded(move(dist), move(next), edges);
+        vector<int> scratch;
+        string line;
+        loaded.formatPath(0, 3, scratch, line);
+        check(line.compare(0, 6, "Error:") == 0, "cyclic next is reported, got: " + line);
+    }
+
+    remove(path.c_str());
+
+    if (failures == 0) {
+        cout << "All snapshot tests passed." << endl;
+        return 0;
+    }
+    return 1;
+}
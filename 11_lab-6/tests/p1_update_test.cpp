@@ -0,0 +1,149 @@
+// Incremental edge updates must leave dist and next exactly as a fresh run on
+// the changed graph would, and rejected updates must leave them untouched.
+//
+// Build and run from 11_lab-6:
+//   g++ -std=c++17 -O2 -pthread tests/p1_update_test.cpp -o p1_update_test
+//   ./p1_update_test
+
+#define P1_NO_MAIN
+#include "../p1.cpp"
+
+#include <random>
+
+static int failures = 0;
+
+static void check(bool condition, const string& what) {
+    if (!condition) {
+        cout << "FAIL: " << what << endl;
+        failures++;
+    }
+}
+
+// Weights are base + p[u] - p[v] with base >= 0, so no cycle is ever negative,
+// however the edges change. base is often 0, which gives zero-weight cycles.
+struct PotentialGraph {
+    vector<long long> potential;
+    DistMatrix graph;
+
+    PotentialGraph(mt19937& rng, int n, double density) : potential(n), graph(n, INF) {
+        for (long long& p : potential) p = (long long)(rng() % 21);
+        for (int i = 0; i < n; i++) {
+            for (int j = 0; j < n; j++) {
+                if (i != j && rng() % 1000 < density * 1000) {
+                    graph[i][j] = weight(rng, i, j);
+                } else if (i == j && rng() % 4 == 0) {
+                    graph[i][j] = (long long)(rng() % 10);
+                }
+            }
+        }
+    }
+
+    long long weight(mt19937& rng, int u, int v) const {
+        long long base = (rng() % 3 == 0) ? 0 : (long long)(rng() % 30);
+        return base + potential[u] - potential[v];
+    }
+};
+
+// dist and next of `fw` against a fresh Floyd-Warshall over `graph`: equal
+// distances, and next hops that walk a path of exactly that length.
+static void expectFresh(const string& name, const FloydWarshall& fw, const DistMatrix& graph) {
+    int n = graph.size();
+    FloydWarshall fresh(n);
+    fresh.setGraph(graph);
+    fresh.setEngine(ENGINE_FLOYD_WARSHALL);
+    check(fresh.computeShortestPaths(), name + ": reference run found a negative cycle");
+
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            string at = name + ": (" + to_string(i) + ", " + to_string(j) + ")";
+            long long expected = fresh.getDistance(i, j);
+            if (fw.getDistance(i, j) != expected) {
+                check(false, at + " distance");
+                return;
+            }
+            if (i == j || expected == UNREACHABLE) continue;
+
+            long long length = 0;
+            int current = i, hops = 0;
+            while (current != j && current != -1 && hops < n) {
+                int hop = fw.getNextHop(current, j);
+                if (hop != -1) length += graph[current][hop];
+                current = hop;
+                hops++;
+            }
+            if (current != j || length != expected) {
+                check(false, at + " path");
+                return;
+            }
+        }
+    }
+}
+
+static vector<long long> snapshotDistances(const FloydWarshall& fw, int n) {
+    vector<long long> all;
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            all.push_back(fw.getDistance(i, j));
+        }
+    }
+    return all;
+}
+
+int main() {
+    mt19937 rng(7);
+
+    // Random batches of increases, removals and decreases
+    for (int trial = 0; trial < 60; trial++) {
+        int n = 2 + rng() % 30;
+        PotentialGraph g(rng, n, (trial % 2 == 0) ? 0.15 : 0.5);
+        FloydWarshall fw(n);
+        fw.setGraph(g.graph);
+        fw.setEngine(ENGINE_FLOYD_WARSHALL);
+        fw.setThreadCount(trial % 3 + 1);
+        check(fw.computeShortestPaths(), "trial " + to_string(trial) + ": unexpected negative cycle");
+
+        for (int round = 0; round < 6; round++) {
+            vector<EdgeUpdate> batch;
+            int size = 1 + rng() % 5;
+            for (int k = 0; k < size; k++) {
+                int u = rng() % n, v = rng() % n;
+                if (u == v) continue;
+                long long w = (rng() % 4 == 0) ? INF : g.weight(rng, u, v);
+                batch.push_back(EdgeUpdate{u, v, w});
+                g.graph[u][v] = w; // the last weight for (u, v) wins
+            }
+            string error;
+            string name = "trial " + to_string(trial) + ", round " + to_string(round);
+            check(fw.applyEdgeUpdates(batch, error), name + ": rejected: " + error);
+            expectFresh(name, fw, g.graph);
+        }
+    }
+
+    // Rejected updates change nothing
+    {
+        DistMatrix graph = DistMatrix::fromRows({{0, 2, INF}, {INF, 0, 3}, {1, INF, 0}}, INF);
+        FloydWarshall fw(3);
+        fw.setGraph(graph);
+        check(fw.computeShortestPaths(), "small graph has no negative cycle");
+        vector<long long> before = snapshotDistances(fw, 3);
+        string error;
+
+        check(!fw.updateEdge(2, 0, -6, error), "decrease closing a negative cycle is rejected");
+        check(snapshotDistances(fw, 3) == before, "rejected decrease leaves dist alone");
+
+        vector<EdgeUpdate> badVertex = {EdgeUpdate{0, 1, 5}, EdgeUpdate{0, 3, 1}};
+        check(!fw.applyEdgeUpdates(badVertex, error), "invalid vertex rejects the batch");
+        check(snapshotDistances(fw, 3) == before, "batch with an invalid vertex changes nothing");
+
+        vector<EdgeUpdate> selfLoop = {EdgeUpdate{0, 1, 5}, EdgeUpdate{1, 1, 1}};
+        check(!fw.applyEdgeUpdates(selfLoop, error), "self-loop rejects the batch");
+        check(snapshotDistances(fw, 3) == before, "batch with a self-loop changes nothing");
+        expectFresh("after rejected updates", fw, graph);
+    }
+
+    if (failures == 0) {
+        cout << "All incremental update tests passed." << endl;
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,150 @@
+// The coordinate MST (Boruvka over the point grid) must weigh exactly as much
+// as a brute-force Prim on the rounded EUC_2D distances, including on
+// degenerate inputs: collinear cities, duplicates and well-separated clusters.
+//
+// Build and run from 11_lab-6:
+//   g++ -std=c++17 -O2 -pthread tests/p3_mst_test.cpp -o p3_mst_test
+//   ./p3_mst_test
+
+#define P3_NO_MAIN
+#include "../p3.cpp"
+
+#include <chrono>
+#include <random>
+#include <string>
+
+static int failures = 0;
+
+static void check(bool condition, const string &what)
+{
+    if (!condition)
+    {
+        cout << "FAIL: " << what << endl;
+        failures++;
+    }
+}
+
+static long long roundedDistance(const vector<double> &x, const vector<double> &y, int a, int b)
+{
+    double dx = x[a] - x[b], dy = y[a] - y[b];
+    return (long long)(sqrt(dx * dx + dy * dy) + 0.5);
+}
+
+// O(n^2) Prim on the rounded distances
+static long long referenceWeight(const vector<double> &x, const vector<double> &y)
+{
+    int n = x.size();
+    vector<long long> key(n, LLONG_MAX);
+    vector<char> inTree(n, 0);
+    key[0] = 0;
+    long long total = 0;
+    for (int step = 0; step < n; step++)
+    {
+        int u = -1;
+        for (int i = 0; i < n; i++)
+            if (!inTree[i] && (u < 0 || key[i] < key[u]))
+                u = i;
+        inTree[u] = 1;
+        total += key[u];
+        for (int i = 0; i < n; i++)
+            if (!inTree[i])
+                key[i] = min(key[i], roundedDistance(x, y, u, i));
+    }
+    return total;
+}
+
+// Solve quietly and return the MST weight and the time it took
+static long long mstWeight(const vector<double> &x, const vector<double> &y, double &seconds)
+{
+    TSP_MST tsp(x.size());
+    tsp.setCoordinates(x, y);
+    auto start = chrono::steady_clock::now();
+    cout.setstate(ios::failbit);
+    tsp.solve();
+    cout.clear();
+    seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    return tsp.getMSTWeight();
+}
+
+// Returns the seconds the solve took
+static double expectExact(const string &name, const vector<double> &x, const vector<double> &y)
+{
+    double seconds;
+    long long got = mstWeight(x, y, seconds);
+    long long expected = referenceWeight(x, y);
+    check(got == expected, name + ": MST weight " + to_string(got) + ", expected " + to_string(expected));
+    return seconds;
+}
+
+int main()
+{
+    mt19937 rng(11);
+    auto uniform = [&](double lo, double hi) { return uniform_real_distribution<double>(lo, hi)(rng); };
+
+    for (int trial = 0; trial < 5; trial++)
+    {
+        int n = 2 + rng() % 400;
+        vector<double> x(n), y(n);
+
+        for (int i = 0; i < n; i++)
+        {
+            x[i] = uniform(0, 1000);
+            y[i] = uniform(0, 1000);
+        }
+        expectExact("uniform " + to_string(trial), x, y);
+
+        // Four clusters far apart: the candidate lists never leave a cluster
+        for (int i = 0; i < n; i++)
+        {
+            int c = rng() % 4;
+            x[i] = (c % 2) * 1e6 + uniform(0, 50);
+            y[i] = (c / 2) * 1e6 + uniform(0, 50);
+        }
+        expectExact("clusters " + to_string(trial), x, y);
+
+        // Many duplicate cities and equal distances
+        for (int i = 0; i < n; i++)
+        {
+            x[i] = rng() % 20;
+            y[i] = rng() % 20;
+        }
+        expectExact("lattice " + to_string(trial), x, y);
+
+        for (int i = 0; i < n; i++)
+        {
+            x[i] = uniform(0, 1e5);
+            y[i] = 42;
+        }
+        double seconds = expectExact("horizontal line " + to_string(trial), x, y);
+        seconds += expectExact("vertical line " + to_string(trial), y, x);
+        check(seconds < 1.0, "collinear trial " + to_string(trial) + " took " + to_string(seconds) + " s");
+    }
+
+    // Collinear cities once sized the grid as 65536 x 1 cells, and every
+    // neighbour query then walked thousands of rings: 15 cities took seconds.
+    {
+        vector<double> x(15), y(15, 3.0);
+        for (int i = 0; i < 15; i++)
+            x[i] = i * 7.5;
+        double seconds = expectExact("15 collinear cities", x, y);
+        check(seconds < 1.0, "15 collinear cities took " + to_string(seconds) + " s");
+
+        int n = 20000;
+        x.assign(n, 0);
+        y.assign(n, 3.0);
+        for (int i = 0; i < n; i++)
+            x[i] = uniform(0, 1e6);
+        long long weight = mstWeight(x, y, seconds);
+        double span = *max_element(x.begin(), x.end()) - *min_element(x.begin(), x.end());
+        check(weight >= (long long)span - n && weight <= (long long)span + n,
+              "20000 collinear cities span the line");
+        check(seconds < 5.0, "20000 collinear cities took " + to_string(seconds) + " s");
+    }
+
+    if (failures == 0)
+    {
+        cout << "All MST tests passed." << endl;
+        return 0;
+    }
+    return 1;
+}